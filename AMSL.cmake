@@ -1,9 +1,12 @@
 function(add_amsl_target target_name target_source_file)
     set(SOURCES
             include/amsl.hpp include/utils.hpp include/string.hpp include/lexer.hpp include/token.hpp
-            include/parser.hpp include/expression.hpp include/ptr_wrapper.hpp include/compiler.hpp include/executor.hpp
+            include/parser.hpp include/expression.hpp include/node_arena.hpp include/compiler.hpp include/executor.hpp
             include/analyzed_expression.hpp include/analyzer.hpp include/encoder.hpp include/bytes.hpp
-            include/traits.hpp include/encodable.hpp include/builtin_functions.hpp
+            include/traits.hpp include/builtin_functions.hpp include/frame.hpp
+            include/char_class.hpp include/symbol_table.hpp include/optimizer.hpp include/host_functions.hpp
+            include/host_variables.hpp include/output.hpp include/format.hpp include/simd.hpp
+            include/parallel.hpp
     )
     add_executable(${target_name} src/main.cpp ${SOURCES})
 
@@ -43,3 +46,83 @@ function(add_amsl_target target_name target_source_file)
     target_compile_definitions(${introspection_target_name} PRIVATE "-DSOURCE_FILE=\"${absolute_generated_source_file}\"")
     add_dependencies(${introspection_target_name} ${generate_source_file_target_name})
 endfunction()
+
+# Builds synthetic scripts of growing size stage by stage and reports build time, peak compiler memory and binary size
+#
+# add_amsl_benchmark(<target_name>
+#         [BASELINE <csv_file>] [TOLERANCE <percent>] [FAIL_ON_REGRESSION]
+#         [STAGES <stage>...]
+#         CASES "<case_name> [statements=N] [depth=N] [variables=N] [strings=N] [string_length=N]"...)
+function(add_amsl_benchmark target_name)
+    cmake_parse_arguments(PARSE_ARGV 1 BENCHMARK "FAIL_ON_REGRESSION" "BASELINE;TOLERANCE" "STAGES;CASES")
+
+    if(NOT BENCHMARK_CASES)
+        message(FATAL_ERROR "add_amsl_benchmark(${target_name}) requires at least one case")
+    endif()
+    if(NOT BENCHMARK_STAGES)
+        set(BENCHMARK_STAGES lexer parser analyzer optimizer encoder compiler executor)
+    endif()
+    if(NOT BENCHMARK_BASELINE)
+        set(BENCHMARK_BASELINE benchmarks/${target_name}.csv)
+    endif()
+    if(NOT BENCHMARK_TOLERANCE)
+        set(BENCHMARK_TOLERANCE 25)
+    endif()
+
+    find_program(AMSL_TIME_EXECUTABLE NAMES time PATHS /usr/bin /bin NO_DEFAULT_PATH)
+
+    set(work_dir ${CMAKE_BINARY_DIR}/${target_name})
+    set(config_file ${work_dir}/config.cmake)
+    set(results_file ${work_dir}/results.csv)
+    set(compile_flags ${CMAKE_CXX${CMAKE_CXX_STANDARD}_EXTENSION_COMPILE_OPTION} "-fconstexpr-depth=1000000000"
+            "-ftemplate-depth=1000000000" "-ftemplate-backtrace-limit=0" "-fconstexpr-ops-limit=1000000000")
+
+    file(WRITE ${config_file} "set(source_dir [==[${CMAKE_SOURCE_DIR}]==])\n")
+    file(APPEND ${config_file} "set(work_dir [==[${work_dir}]==])\n")
+    file(APPEND ${config_file} "set(compiler [==[${CMAKE_CXX_COMPILER}]==])\n")
+    file(APPEND ${config_file} "set(compile_flags [==[${compile_flags}]==])\n")
+    file(APPEND ${config_file} "set(time_executable [==[${AMSL_TIME_EXECUTABLE}]==])\n")
+    file(APPEND ${config_file} "set(cases [==[${BENCHMARK_CASES}]==])\n")
+    file(APPEND ${config_file} "set(stages [==[${BENCHMARK_STAGES}]==])\n")
+    file(APPEND ${config_file} "set(baseline_file [==[${CMAKE_SOURCE_DIR}/${BENCHMARK_BASELINE}]==])\n")
+    file(APPEND ${config_file} "set(results_file [==[${results_file}]==])\n")
+    file(APPEND ${config_file} "set(report_file [==[${work_dir}/report.txt]==])\n")
+    file(APPEND ${config_file} "set(tolerance ${BENCHMARK_TOLERANCE})\n")
+    file(APPEND ${config_file} "set(fail_on_regression ${BENCHMARK_FAIL_ON_REGRESSION})\n")
+
+    add_custom_target(
+            ${target_name}
+            COMMAND ${CMAKE_COMMAND} -Dconfig_file=${config_file} -P "${CMAKE_SOURCE_DIR}/benchmarks/RunBenchmark.cmake"
+            WORKING_DIRECTORY ${CMAKE_SOURCE_DIR}
+            COMMENT "Running AMSL compile-time benchmark ${target_name}"
+            USES_TERMINAL
+    )
+
+    add_custom_target(
+            ${target_name}-update-baseline
+            COMMAND ${CMAKE_COMMAND} -E copy ${results_file} "${CMAKE_SOURCE_DIR}/${BENCHMARK_BASELINE}"
+            COMMENT "Storing ${results_file} as the ${target_name} baseline"
+    )
+    add_dependencies(${target_name}-update-baseline ${target_name})
+endfunction()
+
+# Builds an optimized benchmark executable from <source_file> and runs it with the given arguments
+#
+# add_amsl_runtime_benchmark(<target_name> <source_file> [ARGS <argument>...])
+function(add_amsl_runtime_benchmark target_name source_file)
+    cmake_parse_arguments(PARSE_ARGV 2 BENCHMARK "" "" "ARGS")
+
+    set(runner_name "${target_name}-runner")
+    add_executable(${runner_name} EXCLUDE_FROM_ALL ${source_file})
+    target_include_directories(${runner_name} PRIVATE include)
+    target_compile_options(${runner_name} PRIVATE "-O2" "-fconstexpr-depth=1000000000" "-ftemplate-depth=1000000000"
+            "-ftemplate-backtrace-limit=0" "-fconstexpr-ops-limit=1000000000")
+
+    add_custom_target(
+            ${target_name}
+            COMMAND ${runner_name} ${BENCHMARK_ARGS}
+            WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+            COMMENT "Running AMSL runtime benchmark ${target_name}"
+            USES_TERMINAL
+    )
+endfunction()
@@ -0,0 +1,66 @@
+if(NOT DEFINED output_file)
+    message(FATAL_ERROR "You must define output_file")
+endif()
+
+if(NOT DEFINED statements)
+    set(statements 16)
+endif()
+if(NOT DEFINED depth)
+    set(depth 1)
+endif()
+if(NOT DEFINED variables)
+    set(variables 4)
+endif()
+if(NOT DEFINED strings)
+    set(strings 0)
+endif()
+if(NOT DEFINED string_length)
+    set(string_length 16)
+endif()
+
+if(variables LESS 1 OR depth LESS 1)
+    message(FATAL_ERROR "variables and depth must be at least 1")
+endif()
+
+set(alphabet "abcdefghijklmnopqrstuvwxyz")
+math(EXPR alphabet_repeats "${string_length} / 26 + 1")
+string(REPEAT "${alphabet}" ${alphabet_repeats} literal)
+string(SUBSTRING "${literal}" 0 ${string_length} literal)
+
+set(program "{\n")
+math(EXPR last_variable "${variables} - 1")
+foreach(idx RANGE ${last_variable})
+    string(APPEND program "let v${idx}: int = ${idx};\n")
+endforeach()
+
+math(EXPR nested_blocks "${depth} - 1")
+if(nested_blocks GREATER 0)
+    foreach(idx RANGE 1 ${nested_blocks})
+        string(APPEND program "{\n")
+    endforeach()
+endif()
+
+if(statements GREATER 0)
+    math(EXPR last_statement "${statements} - 1")
+    foreach(idx RANGE ${last_statement})
+        math(EXPR lhs "${idx} % ${variables}")
+        math(EXPR rhs "(${idx} * 7 + 1) % ${variables}")
+        string(APPEND program "apply v${lhs} = @add(v${rhs}, ${idx});\n")
+    endforeach()
+endif()
+
+if(strings GREATER 0)
+    math(EXPR last_string "${strings} - 1")
+    foreach(idx RANGE ${last_string})
+        string(APPEND program "@print(\"${literal}\");\n")
+    endforeach()
+endif()
+
+if(nested_blocks GREATER 0)
+    foreach(idx RANGE 1 ${nested_blocks})
+        string(APPEND program "}\n")
+    endforeach()
+endif()
+
+string(APPEND program "0\n}\n")
+file(WRITE ${output_file} "${program}")
@@ -0,0 +1,186 @@
+if(NOT DEFINED config_file)
+    message(FATAL_ERROR "You must define config_file")
+endif()
+
+include(${config_file})
+
+set(stage_names lexer parser analyzer optimizer encoder compiler executor)
+set(case_parameters statements depth variables strings string_length)
+
+function(read_csv file_name out_prefix)
+    file(STRINGS ${file_name} lines)
+    list(POP_FRONT lines)
+    set(keys)
+    foreach(line IN LISTS lines)
+        string(REPLACE "," ";" fields "${line}")
+        list(GET fields 0 case_name)
+        list(GET fields 1 stage)
+        list(GET fields 7 wall_ms)
+        list(GET fields 8 peak_rss_kb)
+        list(GET fields 9 binary_bytes)
+        set(key "${case_name}/${stage}")
+        list(APPEND keys ${key})
+        set(${out_prefix}_${key}_wall_ms ${wall_ms} PARENT_SCOPE)
+        set(${out_prefix}_${key}_peak_rss_kb ${peak_rss_kb} PARENT_SCOPE)
+        set(${out_prefix}_${key}_binary_bytes ${binary_bytes} PARENT_SCOPE)
+    endforeach()
+    set(${out_prefix}_keys ${keys} PARENT_SCOPE)
+endfunction()
+
+function(pad_right out_var value width)
+    string(LENGTH "${value}" length)
+    if(length LESS width)
+        math(EXPR padding "${width} - ${length}")
+        string(REPEAT " " ${padding} spaces)
+        set(value "${value}${spaces}")
+    endif()
+    set(${out_var} "${value}" PARENT_SCOPE)
+endfunction()
+
+# Appends a line to the report if `current` exceeds `baseline` by more than the configured tolerance
+function(compare_metric key metric baseline current)
+    if(baseline STREQUAL "n/a" OR current STREQUAL "n/a" OR baseline EQUAL 0)
+        return()
+    endif()
+    math(EXPR limit "${baseline} + ${baseline} * ${tolerance} / 100")
+    if(current GREATER limit)
+        math(EXPR percent "(${current} - ${baseline}) * 100 / ${baseline}")
+        set(regressions "${regressions}REGRESSION ${key} ${metric}: ${baseline} -> ${current} (+${percent}%)\n" PARENT_SCOPE)
+    endif()
+endfunction()
+
+file(MAKE_DIRECTORY ${work_dir})
+file(WRITE ${results_file} "case,stage,statements,depth,variables,strings,string_length,wall_ms,peak_rss_kb,binary_bytes\n")
+set(report "AMSL compile-time scaling report\n\n")
+set(report_columns case stage wall_ms stage_ms peak_rss_kb binary_bytes growth)
+set(report_widths 24 10 10 10 13 14 0)
+
+function(append_report_row)
+    set(row "")
+    foreach(value width IN ZIP_LISTS ARGV report_widths)
+        pad_right(value "${value}" ${width})
+        string(APPEND row "${value}")
+    endforeach()
+    set(report "${report}${row}\n" PARENT_SCOPE)
+endfunction()
+
+append_report_row(${report_columns})
+
+set(previous_series "")
+foreach(case IN LISTS cases)
+    string(REPLACE " " ";" case_fields "${case}")
+    list(POP_FRONT case_fields case_name)
+
+    set(statements 16)
+    set(depth 1)
+    set(variables 4)
+    set(strings 0)
+    set(string_length 16)
+    foreach(field IN LISTS case_fields)
+        if(NOT field MATCHES "^([a-z_]+)=([0-9]+)$")
+            message(FATAL_ERROR "Malformed benchmark case parameter '${field}' in '${case_name}'")
+        endif()
+        list(FIND case_parameters ${CMAKE_MATCH_1} parameter_idx)
+        if(parameter_idx EQUAL -1)
+            message(FATAL_ERROR "Unknown benchmark case parameter '${CMAKE_MATCH_1}' in '${case_name}'")
+        endif()
+        set(${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+    endforeach()
+    set(generator_arguments)
+    foreach(parameter IN LISTS case_parameters)
+        list(APPEND generator_arguments -D${parameter}=${${parameter}})
+    endforeach()
+
+    set(case_dir ${work_dir}/${case_name})
+    file(MAKE_DIRECTORY ${case_dir})
+    execute_process(
+            COMMAND ${CMAKE_COMMAND} ${generator_arguments} -Doutput_file=${case_dir}/program.amsl
+            -P ${source_dir}/benchmarks/GenerateProgram.cmake
+            COMMAND_ERROR_IS_FATAL ANY
+    )
+    execute_process(
+            COMMAND ${CMAKE_COMMAND} -Dinput_file=${case_dir}/program.amsl -Doutput_file=${case_dir}/program.amsl.hpp
+            -P ${source_dir}/GenerateSource.cmake
+            COMMAND_ERROR_IS_FATAL ANY
+    )
+
+    # Cases named <series>_<size> are compared with the previous case of the same series
+    string(REGEX REPLACE "_[0-9]+$" "" series "${case_name}")
+
+    set(previous_stage_ms 0)
+    foreach(stage IN LISTS stages)
+        list(FIND stage_names ${stage} stage_idx)
+        if(stage_idx EQUAL -1)
+            message(FATAL_ERROR "Unknown benchmark stage '${stage}'")
+        endif()
+        math(EXPR stage_number "${stage_idx} + 1")
+
+        set(binary ${case_dir}/${stage})
+        set(compile_command ${compiler} ${compile_flags} -I${source_dir}/include
+                "-DSOURCE_FILE=\"${case_dir}/program.amsl.hpp\"" -DAMSL_BENCHMARK_STAGE=${stage_number}
+                ${source_dir}/benchmarks/stage.cpp -o ${binary})
+        if(time_executable)
+            set(compile_command ${time_executable} -f %M -o ${binary}.rss ${compile_command})
+        endif()
+
+        message(STATUS "Benchmarking ${case_name} (${stage})")
+        string(TIMESTAMP start_us "%s%f" UTC)
+        execute_process(COMMAND ${compile_command} RESULT_VARIABLE compile_result ERROR_VARIABLE compile_error)
+        string(TIMESTAMP end_us "%s%f" UTC)
+        if(NOT compile_result EQUAL 0)
+            message(FATAL_ERROR "Building ${case_name} (${stage}) failed:\n${compile_error}")
+        endif()
+
+        math(EXPR wall_ms "(${end_us} - ${start_us}) / 1000")
+        math(EXPR stage_ms "${wall_ms} - ${previous_stage_ms}")
+        set(previous_stage_ms ${wall_ms})
+
+        set(peak_rss_kb "n/a")
+        if(time_executable)
+            file(STRINGS ${binary}.rss rss_lines REGEX "^[0-9]+$")
+            list(GET rss_lines -1 peak_rss_kb)
+        endif()
+        file(SIZE ${binary} binary_bytes)
+
+        set(growth "")
+        set(series_key "${series}/${stage}")
+        if(series STREQUAL previous_series AND DEFINED last_wall_ms_${series_key} AND last_wall_ms_${series_key} GREATER 0)
+            math(EXPR growth_percent "${wall_ms} * 100 / ${last_wall_ms_${series_key}}")
+            set(growth "${growth_percent}%")
+        endif()
+        set(last_wall_ms_${series_key} ${wall_ms})
+
+        file(APPEND ${results_file} "${case_name},${stage},${statements},${depth},${variables},${strings},${string_length},${wall_ms},${peak_rss_kb},${binary_bytes}\n")
+
+        append_report_row(${case_name} ${stage} ${wall_ms} ${stage_ms} ${peak_rss_kb} ${binary_bytes} "${growth}")
+    endforeach()
+    set(previous_series "${series}")
+endforeach()
+
+set(regressions "")
+if(EXISTS ${baseline_file})
+    read_csv(${baseline_file} baseline)
+    read_csv(${results_file} current)
+    foreach(key IN LISTS current_keys)
+        if(NOT DEFINED baseline_${key}_wall_ms)
+            continue()
+        endif()
+        compare_metric(${key} wall_ms ${baseline_${key}_wall_ms} ${current_${key}_wall_ms})
+        compare_metric(${key} peak_rss_kb ${baseline_${key}_peak_rss_kb} ${current_${key}_peak_rss_kb})
+        compare_metric(${key} binary_bytes ${baseline_${key}_binary_bytes} ${current_${key}_binary_bytes})
+    endforeach()
+    if(regressions STREQUAL "")
+        string(APPEND report "\nNo regressions against ${baseline_file} (tolerance ${tolerance}%)\n")
+    else()
+        string(APPEND report "\nRegressions against ${baseline_file} (tolerance ${tolerance}%):\n${regressions}")
+    endif()
+else()
+    string(APPEND report "\nNo baseline at ${baseline_file}, run the -update-baseline target to store one\n")
+endif()
+
+file(WRITE ${report_file} "${report}")
+message("${report}")
+
+if(NOT regressions STREQUAL "" AND fail_on_regression)
+    message(FATAL_ERROR "Compile-time regressions detected, see ${report_file}")
+endif()
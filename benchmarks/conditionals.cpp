@@ -0,0 +1,83 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes a script whose debug path is disabled by a literal flag (the disabled path calls a host function that is
+// never bound, so the script compiles only if the branch is eliminated), the same script without the debug path and
+// a script branching on a flag bound by the host. All of them have to produce the same results, the first two should
+// take the same time per run
+//
+// Usage: conditionals [runs = 10000000]
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+  long input = 0, output = 0, flagged_total = 0, plain_total = 0, host_flag_total = 0, native_total = 0;
+  auto functions = HostFunctions{host_function<"input">([&input]() { return input; })};
+  auto variables = HostVariables{host_variable<"output">(output)};
+
+  auto flagged_ns = measure(runs, 1, [&](int run) {
+    input = run;
+    AMSL{}.execute<R"({
+    let debug: int = 0;
+    let value: int64 = @input();
+    if debug {
+        @println("value: ", @debug_dump(value));
+    }
+    if (@lt(@mul(value, 2), 1000)) {
+        apply output = @add(value, 1);
+    } else {
+        apply output = @sub(value, 1);
+    }
+    0
+})">(functions, variables);
+    flagged_total += output;
+  }) * 1e9;
+  auto plain_ns = measure(runs, 1, [&](int run) {
+    input = run;
+    AMSL{}.execute<R"({
+    let value: int64 = @input();
+    if (@lt(@mul(value, 2), 1000)) {
+        apply output = @add(value, 1);
+    } else {
+        apply output = @sub(value, 1);
+    }
+    0
+})">(functions, variables);
+    plain_total += output;
+  }) * 1e9;
+
+  long debug = 0;
+  auto host_flag_variables = HostVariables{host_variable<"output">(output), host_variable<"debug">(debug)};
+  auto host_flag_ns = measure(runs, 1, [&](int run) {
+    input = run;
+    AMSL{}.execute<R"({
+    let value: int64 = @input();
+    if debug {
+        @println("value: ", value);
+    }
+    if (@lt(@mul(value, 2), 1000)) {
+        apply output = @add(value, 1);
+    } else {
+        apply output = @sub(value, 1);
+    }
+    0
+})">(functions, host_flag_variables);
+    host_flag_total += output;
+  }) * 1e9;
+  for (long run = 0; run < runs; ++run)
+    native_total += run * 2 < 1000 ? run + 1 : run - 1;
+
+  if (flagged_total != native_total || plain_total != native_total || host_flag_total != native_total) {
+    std::cerr << "Script and native results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Literal flag (branch eliminated): " << flagged_ns << " ns per run" << std::endl;
+  std::cout << "Without the debug path: " << plain_ns << " ns per run" << std::endl;
+  std::cout << "Flag bound by the host: " << host_flag_ns << " ns per run" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <streambuf>
+#include <string>
+#include "amsl.hpp"
+
+// Builds the same line with `@format` into a host string, with `@format` printed straight to the output sink and in
+// C++ by concatenating std::to_string results, counting the heap allocations of each. Fails unless formatting into a
+// string allocates once per line and printing never does
+//
+// Usage: format [runs = 1000000]
+
+static std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (auto ptr = std::malloc(size))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+class NullBuffer : public std::streambuf {
+protected:
+  int_type overflow(int_type chr) override {
+    return traits_type::not_eof(chr);
+  }
+
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    return count;
+  }
+};
+
+struct Measurement {
+  double allocations_per_run;
+  double ns_per_run;
+};
+
+template<typename F>
+static Measurement measure(int runs, F &&function) {
+  auto allocations_before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+    function(run);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return {static_cast<double>(allocations - allocations_before) / runs, elapsed.count() * 1e9 / runs};
+}
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  int input = 0;
+  std::string line{}, expected{};
+  auto functions = HostFunctions{host_function<"input">([&input]() { return input; })};
+  auto variables = HostVariables{host_variable<"line">(line)};
+
+  auto to_string = measure(runs, [&](int run) {
+    input = run % 10000;
+    AMSL{}.execute<R"({
+    let b = @input();
+    apply line = @format("[info] b = {}, c = {}, b + c = {}", b, @squared(b), @add(b, @squared(b)));
+    0
+})">(functions, variables);
+  });
+  auto concatenation = measure(runs, [&](int run) {
+    auto b = run % 10000;
+    expected = "[info] b = " + std::to_string(b) + ", c = " + std::to_string(b * b) + ", b + c = " +
+               std::to_string(b + b * b);
+  });
+  if (line != expected) {
+    std::cerr << "Formatted and concatenated lines differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  NullBuffer null_buffer{};
+  auto *output_buffer = std::cout.rdbuf(&null_buffer);
+  auto to_sink = measure(runs, [&](int run) {
+    input = run % 10000;
+    AMSL{}.execute<R"({
+    let b = @input();
+    @println(@format("[info] b = {}, c = {}, b + c = {}", b, @squared(b), @add(b, @squared(b))));
+    0
+})">(functions);
+  });
+  std::cout.rdbuf(output_buffer);
+
+  std::cout << "Runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "@format into a string: " << to_string.allocations_per_run << " allocations, " << to_string.ns_per_run
+            << " ns per run" << std::endl;
+  std::cout << "@format printed: " << to_sink.allocations_per_run << " allocations, " << to_sink.ns_per_run
+            << " ns per run" << std::endl;
+  std::cout << "std::to_string concatenation: " << concatenation.allocations_per_run << " allocations, "
+            << concatenation.ns_per_run << " ns per run" << std::endl;
+  return to_string.allocations_per_run == 1 && to_sink.allocations_per_run == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes a script evaluating a polynomial through script functions (one of them generic) over a range bound by the
+// host, the same script with the function bodies pasted at the call site and the same loop written in C++. All of them
+// have to produce the same results and should take the same time per element
+//
+// Usage: functions [elements = 1048576] [runs = 1000]
+
+int main(int argc, char **argv) {
+  long elements = argc > 1 ? std::atol(argv[1]) : 1048576;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+  long count = 0, total = 0, functions_total = 0, pasted_total = 0, native_total = 0;
+  auto variables = HostVariables{host_variable<"count">(count), host_variable<"total">(total)};
+  auto functions_ns = measure(runs, elements, [&](int run) {
+    count = elements + run % 2;
+    AMSL{}.execute<R"({
+    let twice = [(x) { @add(x, x) }];
+    let poly: [(int64) -> int64] = [(x: int64) -> int64 {
+        @add(@mul(@mul(x, x), 3), @add(@twice(@mul(x, 5)), 7))
+    }];
+    let sum: int64 = 0;
+    for i in 0..count {
+        apply sum = @add(sum, @poly(i));
+    }
+    apply total = sum;
+    0
+})">(HostFunctions{}, variables);
+    functions_total += total;
+  }) * 1e9;
+  auto pasted_ns = measure(runs, elements, [&](int run) {
+    count = elements + run % 2;
+    AMSL{}.execute<R"({
+    let sum: int64 = 0;
+    for i in 0..count {
+        apply sum = @add(sum, @add(@mul(@mul(i, i), 3), @add(@add(@mul(i, 5), @mul(i, 5)), 7)));
+    }
+    apply total = sum;
+    0
+})">(HostFunctions{}, variables);
+    pasted_total += total;
+  }) * 1e9;
+  auto native_ns = measure(runs, elements, [&](int run) {
+    long bound = elements + run % 2, sum = 0;
+    for (long i = 0; i < bound; ++i)
+      sum += i * i * 3 + i * 5 * 2 + 7;
+    native_total += sum;
+  }) * 1e9;
+
+  if (functions_total != native_total || pasted_total != native_total) {
+    std::cerr << "Script and native results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Elements: " << elements << ", runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Script functions: " << functions_ns << " ns per element" << std::endl;
+  std::cout << "Pasted function bodies: " << pasted_ns << " ns per element" << std::endl;
+  std::cout << "Native: " << native_ns << " ns per element" << std::endl;
+  return EXIT_SUCCESS;
+}
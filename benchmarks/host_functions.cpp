@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes a script calling host functions (a capturing lambda and a function pointer) and the same computation
+// written directly in C++, both have to produce the same result and should take the same time, as host functions are
+// called without any type erasure
+//
+// Usage: host_functions [runs = 10000000]
+
+static int scale(int value) {
+  return value * 3;
+}
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+  long script_total = 0, native_total = 0;
+  int input = 0;
+  auto functions = HostFunctions{
+    host_function<"input">([&input]() { return input; }),
+    host_function<"scale">(&scale),
+    host_function<"accumulate">([&script_total](int value) { script_total += value; })};
+  auto script_ns = measure(runs, 1, [&](int run) {
+    input = run;
+    AMSL{}.execute<R"({
+    let value = @input();
+    @accumulate(@scale(@add(value, 1)));
+    @accumulate(@squared(@sub(value, 7)));
+    0
+})">(functions);
+  }) * 1e9;
+  auto native_ns = measure(runs, 1, [&](int run) {
+    native_total += scale(run + 1);
+    native_total += (run - 7) * (run - 7);
+  }) * 1e9;
+
+  if (script_total != native_total) {
+    std::cerr << "Script and native results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(2) << "Script: " << script_ns << " ns per run" << std::endl;
+  std::cout << "Native: " << native_ns << " ns per run" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <span>
+#include <vector>
+#include "amsl.hpp"
+
+// Binds a large buffer, an accumulator and a counter to script variables and executes a script summing the buffer
+// through a host function several times. Counts the heap allocations made by the script runs and fails if there are
+// any (the buffer is never copied) or if the results read back differ from the expected ones
+//
+// Usage: host_variables [elements = 16777216] [runs = 16]
+
+static std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (auto ptr = std::malloc(size))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+int main(int argc, char **argv) {
+  std::size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16777216;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 16;
+
+  std::vector<int> buffer(elements);
+  std::iota(buffer.begin(), buffer.end(), 0);
+  std::span<const int> data{buffer};
+  long total = 0;
+  int executed = 0;
+
+  auto functions = HostFunctions{host_function<"sum">([](std::span<const int> values) {
+    return std::accumulate(values.begin(), values.end(), 0L);
+  })};
+  auto variables = HostVariables{host_variable<"data">(data), host_variable<"total">(total),
+                                 host_variable<"executed">(executed)};
+
+  auto allocations_before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+    AMSL{}.execute<R"({
+    apply total = @add(total, @sum(data));
+    @inc(executed);
+    0
+})">(functions, variables);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  auto script_allocations = allocations - allocations_before;
+
+  auto expected_total = static_cast<long>(runs) * std::accumulate(buffer.begin(), buffer.end(), 0L);
+  std::cout << "Elements: " << elements << ", runs: " << runs << std::endl;
+  std::cout << "Allocations: " << script_allocations << std::endl;
+  std::cout << "Time per run: " << std::fixed << std::setprecision(3) << elapsed.count() * 1000 / runs << " ms"
+            << std::endl;
+  if (total != expected_total || executed != runs) {
+    std::cerr << "Results read back from the script differ from the expected ones" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return script_allocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
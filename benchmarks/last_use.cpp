@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include "amsl.hpp"
+
+// Executes a script growing a string through a chain of locals, each read for the last time, and the same chain
+// written in C++ the way the executor ran it before last reads were moves (every read copies, every local lives until
+// the end). Counts heap allocations and the peak of live heap bytes of both, fails if the results differ or if the
+// script does not peak lower
+//
+// Usage: last_use [chunk size = 1048576] [runs = 64]
+
+static std::size_t allocations = 0, live_bytes = 0, peak_bytes = 0;
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (auto ptr = std::malloc(size)) {
+    live_bytes += malloc_usable_size(ptr);
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept {
+  live_bytes -= malloc_usable_size(ptr);
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  live_bytes -= malloc_usable_size(ptr);
+  std::free(ptr);
+}
+
+struct Measurement {
+  double allocations_per_run;
+  std::size_t peak_bytes;
+  double ms_per_run;
+};
+
+template<typename F>
+static Measurement measure(int runs, F &&function) {
+  auto allocations_before = allocations;
+  auto live_before = live_bytes;
+  peak_bytes = live_bytes;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+    function();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return {static_cast<double>(allocations - allocations_before) / runs, peak_bytes - live_before,
+          elapsed.count() * 1e3 / runs};
+}
+
+static std::string copying_add(std::string lhs, std::string rhs) {
+  return lhs + rhs;
+}
+
+int main(int argc, char **argv) {
+  std::size_t chunk_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1048576;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 64;
+
+  std::string chunk(chunk_size, 'a'), suffix(chunk_size, 'b');
+  std::string result{}, expected{};
+  auto functions = HostFunctions{
+    host_function<"input">([&chunk]() { return chunk; }),
+    host_function<"suffix">([&suffix]() { return suffix; })};
+  auto variables = HostVariables{host_variable<"result">(result)};
+
+  auto script = measure(runs, [&]() {
+    AMSL{}.execute<R"({
+    let chunk = @input();
+    let text = @add(chunk, @suffix());
+    apply text = @add(text, @suffix());
+    apply text = @add(text, @suffix());
+    apply result = text;
+    0
+})">(functions, variables);
+  });
+  auto copying = measure(runs, [&]() {
+    std::string local_chunk = chunk;
+    std::string text = copying_add(local_chunk, suffix);
+    text = copying_add(text, suffix);
+    text = copying_add(text, suffix);
+    expected = text;
+  });
+
+  if (result != expected) {
+    std::cerr << "Script and reference results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Runs: " << runs << ", result: " << result.size() << " bytes" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Script: " << script.allocations_per_run << " allocations, peak " << script.peak_bytes
+            << " bytes, " << script.ms_per_run << " ms per run" << std::endl;
+  std::cout << "Copying reference: " << copying.allocations_per_run << " allocations, peak " << copying.peak_bytes
+            << " bytes, " << copying.ms_per_run << " ms per run" << std::endl;
+  return script.peak_bytes < copying.peak_bytes ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "lexer.hpp"
+#include "reference_lexer.hpp"
+
+// Lexes a multi-megabyte synthetic script with the table-driven lexer and the reference one, checks that both produce
+// the same tokens and reports the best throughput of several runs
+//
+// Usage: lexer [megabytes = 16] [runs = 5]
+
+static std::string generate_source(std::size_t size) {
+  constexpr std::string_view chunk = R"({
+    let value: int = 0x7FFF;
+    let mask = 0b1010_1010;
+    let octal: int16 = 0755;
+    apply value = @add(value, @squared(mask), 1234567);
+    @println("value = ", value, ", escaped \"text\"\t", octal);
+    let message: string = "The quick brown fox jumps over the lazy dog";
+    @print(message, [&value], {!done}, -1, 2 * 3 / 4 + 5 < 6 > 7 | 8);
+    0
+}
+)";
+  std::string source{};
+  source.reserve(size + chunk.size());
+  while (source.size() < size)
+    source += chunk;
+  return source;
+}
+
+template<typename L>
+static std::pair<double, std::vector<Token>> measure(std::string_view source, int runs) {
+  double best_seconds = 0;
+  std::vector<Token> tokens{};
+  for (int run = 0; run < runs; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    tokens = L{source}.tokenize();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < best_seconds)
+      best_seconds = elapsed.count();
+  }
+  return {best_seconds, std::move(tokens)};
+}
+
+static bool same_tokens(const std::vector<Token> &lhs, const std::vector<Token> &rhs) {
+  return std::ranges::equal(lhs, rhs, [](const Token &a, const Token &b) {
+    return a.kind == b.kind && a.offset == b.offset && a.length == b.length;
+  });
+}
+
+int main(int argc, char **argv) {
+  std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  auto source = generate_source(megabytes << 20);
+  auto [reference_seconds, reference_tokens] = measure<ReferenceLexer>(source, runs);
+  auto [seconds, tokens] = measure<Lexer>(source, runs);
+
+  if (!same_tokens(reference_tokens, tokens)) {
+    std::cerr << "Lexers disagree on the generated source" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  double size_mb = static_cast<double>(source.size()) / (1 << 20);
+  std::cout << "Source: " << std::fixed << std::setprecision(1) << size_mb << " MB, " << tokens.size()
+            << " tokens, best of " << runs << " runs" << std::endl;
+  std::cout << std::left << std::setw(12) << "lexer" << std::setw(12) << "ms" << "MB/s" << std::endl;
+  std::cout << std::setw(12) << "reference" << std::setw(12) << reference_seconds * 1000
+            << size_mb / reference_seconds << std::endl;
+  std::cout << std::setw(12) << "table" << std::setw(12) << seconds * 1000 << size_mb / seconds << std::endl;
+  std::cout << "Speedup: " << std::setprecision(2) << reference_seconds / seconds << "x" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <streambuf>
+#include "amsl.hpp"
+
+// Executes a script printing only string literals and counts the heap allocations it makes, output goes to a
+// discarding stream buffer so that only the executor is measured. Fails if any allocation is made
+//
+// Usage: literal_printing [runs = 100000]
+
+static std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (auto ptr = std::malloc(size))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+class NullBuffer : public std::streambuf {
+protected:
+  int_type overflow(int_type chr) override {
+    return traits_type::not_eof(chr);
+  }
+
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    return count;
+  }
+};
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+  NullBuffer null_buffer{};
+  auto *output_buffer = std::cout.rdbuf(&null_buffer);
+  auto allocations_before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+    AMSL{}.execute<R"({
+    @print("[info] ", "starting", " the literal printing benchmark");
+    @println("[info] ", "a string literal that is too long to fit into the small string buffer");
+    @println("[warn] ", "another one, ", "split ", "into ", "several ", "arguments");
+    0
+})">();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  auto script_allocations = allocations - allocations_before;
+  std::cout.rdbuf(output_buffer);
+
+  std::cout << "Runs: " << runs << std::endl;
+  std::cout << "Allocations: " << script_allocations << std::endl;
+  std::cout << "Time per run: " << std::fixed << std::setprecision(1) << elapsed.count() * 1e9 / runs << " ns"
+            << std::endl;
+  return script_allocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,76 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes a script summing squares over a range bound by the host, lowered to a plain counted loop, and a script
+// summing over a literal range, which is fully unrolled, against the same loops written in C++. Both have to produce
+// the same results and should take the same time per element
+//
+// Usage: loops [elements = 1048576] [runs = 1000]
+
+int main(int argc, char **argv) {
+  long elements = argc > 1 ? std::atol(argv[1]) : 1048576;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+  long count = 0, total = 0, script_total = 0, native_total = 0;
+  auto variables = HostVariables{host_variable<"count">(count), host_variable<"total">(total)};
+  auto range_script_ns = measure(runs, elements, [&](int run) {
+    count = elements + run % 2;
+    AMSL{}.execute<R"({
+    let sum: int64 = 0;
+    for i in 0..count {
+        apply sum = @add(sum, @mul(i, i));
+    }
+    apply total = sum;
+    0
+})">(HostFunctions{}, variables);
+    script_total += total;
+  }) * 1e9;
+  auto range_native_ns = measure(runs, elements, [&](int run) {
+    long bound = elements + run % 2, sum = 0;
+    for (long i = 0; i < bound; ++i)
+      sum += i * i;
+    native_total += sum;
+  }) * 1e9;
+  if (script_total != native_total) {
+    std::cerr << "Script and native range loop results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  long value = 0;
+  script_total = native_total = 0;
+  auto functions = HostFunctions{host_function<"value">([&value]() { return value; })};
+  auto unrolled_script_ns = measure(runs * 1000, 16, [&](int run) {
+    value = run;
+    AMSL{}.execute<R"({
+    let step = @value();
+    let sum: int64 = 0;
+    for i in 0..16 {
+        apply sum = @add(sum, @mul(i, step));
+    }
+    apply total = sum;
+    0
+})">(functions, variables);
+    script_total += total;
+  }) * 1e9;
+  auto unrolled_native_ns = measure(runs * 1000, 16, [&](int run) {
+    long sum = 0;
+    for (long i = 0; i < 16; ++i)
+      sum += i * run;
+    native_total += sum;
+  }) * 1e9;
+  if (script_total != native_total) {
+    std::cerr << "Script and native unrolled loop results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Elements: " << elements << ", runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Range loop, script: " << range_script_ns << " ns per element" << std::endl;
+  std::cout << "Range loop, native: " << range_native_ns << " ns per element" << std::endl;
+  std::cout << "Literal range (unrolled), script: " << unrolled_script_ns << " ns per element" << std::endl;
+  std::cout << "Literal range, native: " << unrolled_native_ns << " ns per element" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,36 @@
+#ifndef AMSL_BENCHMARKS_MEASURE_HPP
+#define AMSL_BENCHMARKS_MEASURE_HPP
+
+#include <chrono>
+#include <concepts>
+
+// Seconds the fastest of `runs` calls of `function` takes
+template<typename F>
+double fastest_run(int runs, F &&function) {
+  double best_seconds = 0;
+  for (int run = 0; run < runs; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < best_seconds)
+      best_seconds = elapsed.count();
+  }
+  return best_seconds;
+}
+
+// Mean seconds per unit of work over `runs` calls of `function`, every call doing `units` of it (elements, recursion
+// levels, 1 for the whole call). `function` is passed the index of the run when it takes one
+template<typename F>
+double measure(int runs, double units, F &&function) {
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run) {
+    if constexpr (std::invocable<F &, int>)
+      function(run);
+    else
+      function();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (static_cast<double>(runs) * units);
+}
+
+#endif // AMSL_BENCHMARKS_MEASURE_HPP
@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Prints the same lines through the previous `println` implementation (iostreams flushed with `std::endl` after every
+// line) and through the buffered output sink, once writing through std::cout and once with write(2). Standard output
+// is redirected to a temporary file while measuring, so every path pays for its real writes, all of them have to
+// produce the same bytes
+//
+// Usage: output_throughput [runs = 1000000]
+
+// Runs per second, what the runs print is stored in `output`
+template<typename F>
+static double measure_output(int runs, std::string &output, F &&function) {
+  std::fflush(stdout);
+  auto *file = std::tmpfile();
+  auto saved_descriptor = ::dup(STDOUT_FILENO);
+  ::dup2(::fileno(file), STDOUT_FILENO);
+
+  // One call making every run, so that the final flush is measured too
+  auto seconds_per_run = measure(1, runs, [&]() {
+    for (int run = 0; run < runs; ++run)
+      function(run);
+    output_sink().flush();
+    std::fflush(stdout);
+  });
+
+  ::dup2(saved_descriptor, STDOUT_FILENO);
+  ::close(saved_descriptor);
+  std::rewind(file);
+  output.clear();
+  char chunk[4096];
+  while (auto count = std::fread(chunk, 1, sizeof(chunk), file))
+    output.append(chunk, count);
+  std::fclose(file);
+  return 1 / seconds_per_run;
+}
+
+static void print_script(int run) {
+  AMSL{}.execute<R"({
+    let value = @input();
+    @println("[info] processed item ", value, " of the batch");
+    @println("[info] ratio ", @ratio(), ", next ", @add(value, 1));
+    0
+})">(HostFunctions{
+    host_function<"input">([run]() { return run; }),
+    host_function<"ratio">([run]() { return run / 3.0; })});
+}
+
+int main(int argc, char **argv) {
+  int runs = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  std::string iostream_output{}, stream_output{}, direct_output{};
+  auto iostream_runs = measure_output(runs, iostream_output, [](int run) {
+    std::cout << "[info] processed item " << run << " of the batch" << std::endl;
+    std::cout << "[info] ratio " << run / 3.0 << ", next " << run + 1 << std::endl;
+  });
+  output_sink().configure({.policy = FlushPolicy::SIZE});
+  auto stream_runs = measure_output(runs, stream_output, print_script);
+  output_sink().configure({.policy = FlushPolicy::SIZE, .direct_write = true});
+  auto direct_runs = measure_output(runs, direct_output, print_script);
+  output_sink().configure({});
+
+  if (stream_output != iostream_output || direct_output != iostream_output) {
+    std::cerr << "Buffered and iostream outputs differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto lines = 2.0;
+  std::cout << "Runs: " << runs << ", output: " << iostream_output.size() << " bytes" << std::endl;
+  std::cout << std::fixed << std::setprecision(0) << "iostream + std::endl: " << iostream_runs * lines
+            << " lines/s" << std::endl;
+  std::cout << "Sink through std::cout: " << stream_runs * lines << " lines/s" << std::endl;
+  std::cout << "Sink with write(2): " << direct_runs * lines << " lines/s" << std::endl;
+  return EXIT_SUCCESS;
+}
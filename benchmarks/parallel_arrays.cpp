@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes a script mapping an array bound by the host through a script function (64 rounds of a multiplicative hash
+// per element), reducing the results and sorting a copy of the array, with the array builtins split over 1 to N
+// threads. Fails if any thread count computes results that differ from the ones computed in C++, a reduction into a
+// double accumulator (which is folded by one thread) has to match the C++ loop exactly. Reports the time per run and
+// the speedup over one thread of each
+//
+// Usage: parallel_arrays [elements = 4194304] [runs = 5] [max threads = hardware threads]
+
+static std::uint64_t mix(std::uint64_t value) {
+  for (int round = 0; round < 64; ++round)
+    value = value * 31 + 7;
+  return value;
+}
+
+int main(int argc, char **argv) {
+  std::size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4194304;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+  unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3]))
+                                  : std::max(std::thread::hardware_concurrency(), 1U);
+
+  std::vector<std::uint64_t> values(elements), sorted{};
+  for (std::size_t idx = 0; idx < elements; ++idx)
+    values[idx] = idx * 2654435761U % 1000003;
+  std::uint64_t total = 0, expected_total = 0;
+  double weighted = 0, expected_weighted = 0;
+  for (auto value: values) {
+    expected_total += mix(value);
+    expected_weighted += static_cast<double>(value * 3);
+  }
+  auto expected_sorted = values;
+  std::ranges::sort(expected_sorted);
+  auto variables = HostVariables{host_variable<"values">(values), host_variable<"sorted">(sorted),
+                                 host_variable<"total">(total), host_variable<"weighted">(weighted)};
+
+  std::cout << "Elements: " << elements << ", runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  double map_reduce_base = 0, sort_base = 0;
+  for (unsigned threads = 1; threads <= max_threads; ++threads) {
+    parallel_runner().configure({.threads = threads});
+    auto map_reduce_ms = measure(runs, 1, [&]() {
+      AMSL{}.execute<R"({
+    let mix = [(value: uint64) -> uint64 {
+        let hash: uint64 = value;
+        for round in 0..64 {
+            apply hash = @add(@mul(hash, 31), 7);
+        }
+        hash
+    }];
+    let plus = [(lhs: uint64, rhs: uint64) -> uint64 { @add(lhs, rhs) }];
+    apply total = @reduce(@map(values, mix), 0, plus);
+    0
+})">(HostFunctions{}, variables);
+    }) * 1e3;
+    AMSL{}.execute<R"({
+    let weigh = [(sum: double, value: uint64) -> double { @add(sum, @mul(value, 3)) }];
+    apply weighted = @reduce(values, 0, weigh);
+    0
+})">(HostFunctions{}, variables);
+    auto sort_ms = measure(runs, 1, [&]() {
+      AMSL{}.execute<R"({
+    let data: array<uint64> = values;
+    @sort(data);
+    apply sorted = data;
+    0
+})">(HostFunctions{}, variables);
+    }) * 1e3;
+    if (total != expected_total || weighted != expected_weighted || sorted != expected_sorted) {
+      std::cerr << "Script and native results differ with " << threads << " threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (threads == 1) {
+      map_reduce_base = map_reduce_ms;
+      sort_base = sort_ms;
+    }
+    std::cout << "Threads: " << threads << ", map and reduce: " << map_reduce_ms << " ms (x"
+              << map_reduce_base / map_reduce_ms << "), sort: " << sort_ms << " ms (x" << sort_base / sort_ms << ")"
+              << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#ifndef AMSL_REFERENCE_LEXER_HPP
+#define AMSL_REFERENCE_LEXER_HPP
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <utility>
+#include "token.hpp"
+#include "utils.hpp"
+
+struct ReferenceLexerState {
+  std::size_t current_idx{};
+  std::size_t token_start{};
+  bool quoted{};
+  bool escaped{};
+  std::vector<Token> tokens{};
+};
+
+// Lexer as of before the table-driven automaton (linear delimiter search, prefix re-scan of every word), kept as the
+// baseline of the lexer benchmark
+class ReferenceLexer {
+public:
+  constexpr explicit ReferenceLexer(std::string_view str) : str{str} {}
+
+  constexpr std::vector<Token> tokenize() {
+    state = ReferenceLexerState{};
+    while (state.current_idx < str.size())
+      proceed();
+    if (state.quoted)
+      emplace_token(TokenKind::STRING_LITERAL, state.token_start, str.size() - state.token_start);
+    else
+      push_token(str.size());
+    return std::move(state.tokens);
+  }
+
+private:
+  constexpr void proceed() {
+    if (state.current_idx >= str.size())
+      return;
+
+    std::size_t idx = state.current_idx++;
+    char chr = str[idx];
+
+    if (state.quoted) {
+      if (state.escaped)
+        state.escaped = false;
+      else if (chr == '\\')
+        state.escaped = true;
+      else if (chr == '\"') {
+        emplace_token(TokenKind::STRING_LITERAL, state.token_start, idx - state.token_start);
+        state.quoted = false;
+        state.token_start = state.current_idx;
+      }
+    } else if (chr == '\"') {
+      push_token(idx);
+      state.quoted = true;
+      state.token_start = state.current_idx;
+    } else if (is_whitespace(chr)) {
+      push_token(idx);
+      state.token_start = state.current_idx;
+    } else if (auto it = std::ranges::find(delimiters, chr, &std::pair<char, TokenKind>::first);
+      it != delimiters.end()) {
+      push_token(idx);
+      emplace_token(it->second, idx, 1);
+      state.token_start = state.current_idx;
+    }
+  }
+
+  constexpr void push_token(std::size_t end) {
+    if (end == state.token_start)
+      return;
+
+    auto raw_token = str.substr(state.token_start, end - state.token_start);
+    emplace_token(classify(raw_token), state.token_start, raw_token.size());
+  }
+
+  constexpr void emplace_token(TokenKind kind, std::size_t offset, std::size_t length) {
+    state.tokens.push_back({kind, static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(length)});
+  }
+
+  static constexpr bool is_whitespace(char c) {
+    constexpr char whitespaces[]{' ', '\n', '\r', '\f', '\v', '\t'};
+    return std::any_of(std::begin(whitespaces), std::end(whitespaces), [c](char chr) { return c == chr; });
+  }
+
+  static constexpr bool is_int_literal(std::string_view str) {
+    for (const auto &[prefix, base]: int_literal_prefixes)
+      if (str.starts_with(prefix) && str.size() > prefix.size())
+        return true;
+    return !str.empty() && std::ranges::all_of(str, [](char chr) { return ('0' <= chr) && (chr <= '9'); });
+  }
+
+  static constexpr TokenKind classify(std::string_view raw_token) {
+    if (is_int_literal(raw_token))
+      return TokenKind::INT_LITERAL;
+    for (const auto &[keyword, kind]: keywords)
+      if (raw_token == keyword)
+        return kind;
+    return TokenKind::IDENTIFIER;
+  }
+
+  static constexpr auto keywords = std::to_array<std::pair<std::string_view, TokenKind>>({
+    {"let",   TokenKind::LET},
+    {"apply", TokenKind::APPLY}});
+
+  static constexpr auto delimiters = std::to_array<std::pair<char, TokenKind>>({
+    {';', TokenKind::SEMICOLON}, {':', TokenKind::COLON}, {',', TokenKind::COMMA}, {'.', TokenKind::DOT},
+    {'-', TokenKind::MINUS}, {'+', TokenKind::PLUS}, {'*', TokenKind::STAR}, {'/', TokenKind::SLASH},
+    {'(', TokenKind::LEFT_PAREN}, {')', TokenKind::RIGHT_PAREN}, {'[', TokenKind::LEFT_BRACKET},
+    {']', TokenKind::RIGHT_BRACKET}, {'{', TokenKind::LEFT_BRACE}, {'}', TokenKind::RIGHT_BRACE},
+    {'<', TokenKind::LESS}, {'>', TokenKind::GREATER}, {'@', TokenKind::AT}, {'&', TokenKind::AMPERSAND},
+    {'|', TokenKind::PIPE}, {'=', TokenKind::EQUAL}, {'!', TokenKind::EXCLAMATION}});
+
+  std::string_view str{};
+  ReferenceLexerState state{};
+};
+
+#endif // AMSL_REFERENCE_LEXER_HPP
@@ -0,0 +1,43 @@
+#ifndef AMSL_REFERENCE_SYMBOL_TABLE_HPP
+#define AMSL_REFERENCE_SYMBOL_TABLE_HPP
+
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Variable resolution as the analyzer did it before the hashed symbol table, kept to benchmark against
+class ReferenceSymbolTable {
+public:
+  static constexpr std::size_t unbound = std::string::npos;
+
+  constexpr void enter_scope() {
+    scopes.emplace_back();
+  }
+
+  constexpr void leave_scope() {
+    scopes.pop_back();
+  }
+
+  constexpr void declare(std::string_view name, std::size_t ref_id) {
+    scopes.back().push_back({name, ref_id});
+  }
+
+  [[nodiscard]] constexpr std::size_t lookup(std::string_view name) const {
+    for (const auto &scope: scopes | std::views::reverse)
+      for (const auto &variable: scope | std::views::reverse)
+        if (variable.name == name)
+          return variable.ref_id;
+    return unbound;
+  }
+
+private:
+  struct Variable {
+    std::string_view name{};
+    std::size_t ref_id{};
+  };
+
+  std::vector<std::vector<Variable>> scopes{};
+};
+
+#endif // AMSL_REFERENCE_SYMBOL_TABLE_HPP
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <vector>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes scripts computing a dot product and `y = x * scale + y` over buffers bound by the host with `vec<float, 8>`
+// arithmetic, the same loops written in C++ with the same vector type and plain scalar C++ loops. The script and the
+// vector C++ results have to be equal, the scalar dot product (summed in another order) has to be close to them
+//
+// Usage: simd [elements = 1048576] [runs = 1000]
+
+using float8 = SimdType<float, 8>::type;
+
+int main(int argc, char **argv) {
+  std::size_t elements = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1048576) / 8 * 8;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+  std::vector<float> xs(elements), ys(elements), script_out(elements), native_out(elements);
+  for (std::size_t idx = 0; idx < elements; ++idx) {
+    xs[idx] = static_cast<float>(idx % 7) * 0.25f;
+    ys[idx] = static_cast<float>(idx % 5) * 0.5f;
+  }
+  long blocks = static_cast<long>(elements / 8);
+  float total = 0, scale = 0.5f;
+  std::span<const float> x_view{xs}, y_view{ys};
+  std::span<float> out_view{script_out};
+  auto variables = HostVariables{host_variable<"xs">(x_view), host_variable<"ys">(y_view),
+                                 host_variable<"out">(out_view), host_variable<"blocks">(blocks),
+                                 host_variable<"scale">(scale), host_variable<"total">(total)};
+
+  auto dot_script_ns = measure(runs, elements, [&]() {
+    AMSL{}.execute<R"({
+    let acc: vec<float, 8>;
+    let x: vec<float, 8>;
+    let y: vec<float, 8>;
+    for block in 0..blocks {
+        let offset = @mul(block, 8);
+        @load(x, xs, offset);
+        @load(y, ys, offset);
+        apply acc = @add(acc, @mul(x, y));
+    }
+    apply total = @hsum(acc);
+    0
+})">(HostFunctions{}, variables);
+  }) * 1e9;
+  float vector_total = 0;
+  auto dot_vector_ns = measure(runs, elements, [&]() {
+    float8 acc{}, x, y;
+    for (std::size_t offset = 0; offset < elements; offset += 8) {
+      std::memcpy(&x, xs.data() + offset, sizeof(x));
+      std::memcpy(&y, ys.data() + offset, sizeof(y));
+      acc += x * y;
+    }
+    vector_total = 0;
+    for (int lane = 0; lane < 8; ++lane)
+      vector_total += acc[lane];
+  }) * 1e9;
+  float scalar_total = 0;
+  auto dot_scalar_ns = measure(runs, elements, [&]() {
+    scalar_total = 0;
+    for (std::size_t idx = 0; idx < elements; ++idx)
+      scalar_total += xs[idx] * ys[idx];
+  }) * 1e9;
+  if (total != vector_total || std::abs(total - scalar_total) > 1e-3f * std::abs(scalar_total)) {
+    std::cerr << "Script and native dot products differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto axpy_script_ns = measure(runs, elements, [&]() {
+    AMSL{}.execute<R"({
+    let x: vec<float, 8>;
+    let y: vec<float, 8>;
+    for block in 0..blocks {
+        let offset = @mul(block, 8);
+        @load(x, xs, offset);
+        @load(y, out, offset);
+        @store(out, offset, @add(@mul(x, scale), y));
+    }
+    0
+})">(HostFunctions{}, variables);
+  }) * 1e9;
+  auto axpy_vector_ns = measure(runs, elements, [&]() {
+    float8 x, y;
+    for (std::size_t offset = 0; offset < elements; offset += 8) {
+      std::memcpy(&x, xs.data() + offset, sizeof(x));
+      std::memcpy(&y, native_out.data() + offset, sizeof(y));
+      y = x * scale + y;
+      std::memcpy(native_out.data() + offset, &y, sizeof(y));
+    }
+  }) * 1e9;
+  if (script_out != native_out) {
+    std::cerr << "Script and native vectors differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Elements: " << elements << ", runs: " << runs << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Dot product, script vec<float, 8>: " << dot_script_ns << " ns per element" << std::endl;
+  std::cout << "Dot product, native vector: " << dot_vector_ns << " ns per element" << std::endl;
+  std::cout << "Dot product, native scalar: " << dot_scalar_ns << " ns per element" << std::endl;
+  std::cout << "x * scale + y, script vec<float, 8>: " << axpy_script_ns << " ns per element" << std::endl;
+  std::cout << "x * scale + y, native vector: " << axpy_vector_ns << " ns per element" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include "amsl.hpp"
+#include "compiler.hpp"
+#include "encoder.hpp"
+#include "optimizer.hpp"
+
+// Compiles the embedded script only up to AMSL_BENCHMARK_STAGE, so that the build cost of every stage can be measured
+// as the difference between two consecutive stages
+#define AMSL_STAGE_LEXER 1
+#define AMSL_STAGE_PARSER 2
+#define AMSL_STAGE_ANALYZER 3
+#define AMSL_STAGE_OPTIMIZER 4
+#define AMSL_STAGE_ENCODER 5
+#define AMSL_STAGE_COMPILER 6
+#define AMSL_STAGE_EXECUTOR 7
+
+#ifndef AMSL_BENCHMARK_STAGE
+#define AMSL_BENCHMARK_STAGE AMSL_STAGE_EXECUTOR
+#endif
+
+int main() {
+  #include SOURCE_FILE
+
+#if AMSL_BENCHMARK_STAGE >= AMSL_STAGE_EXECUTOR
+  return AMSL{}.execute<source>();
+#elif AMSL_BENCHMARK_STAGE == AMSL_STAGE_COMPILER
+  auto generator = []() {
+    auto tokens = Lexer{source}.tokenize();
+    auto expression = Parser{source, tokens}.parse();
+    auto analyzed_expression = Analyzer{expression}.analyze();
+    auto optimized_expression = Optimizer{analyzed_expression}.optimize();
+    return encode_to_bytes(optimized_expression);
+  };
+  static constexpr auto byte_array = to_byte_array(generator);
+  using TB_AST = ProgramCompiler<byte_array.begin()>::compiled;
+  return get_type_name<TB_AST>().empty();
+#else
+  static constexpr std::size_t result = []() {
+    auto tokens = Lexer{source}.tokenize();
+#if AMSL_BENCHMARK_STAGE >= AMSL_STAGE_PARSER
+    auto expression = Parser{source, tokens}.parse();
+#endif
+#if AMSL_BENCHMARK_STAGE >= AMSL_STAGE_ANALYZER
+    auto analyzed_expression = Analyzer{expression}.analyze();
+#endif
+#if AMSL_BENCHMARK_STAGE >= AMSL_STAGE_OPTIMIZER
+    auto optimized_expression = Optimizer{analyzed_expression}.optimize();
+#endif
+#if AMSL_BENCHMARK_STAGE >= AMSL_STAGE_ENCODER
+    return encode_to_bytes(optimized_expression).size();
+#else
+    return tokens.size();
+#endif
+  }();
+  return result == 0;
+#endif
+}
@@ -0,0 +1,101 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "analyzer.hpp"
+#include "reference_symbol_table.hpp"
+#include "measure.hpp"
+
+// Analyzes a synthetic script with thousands of locals, each statement referencing two of them, and reports the best
+// time of several runs for every front-end stage. The same declarations and references are then resolved with the
+// hashed symbol table and with the reference (linear scan) one, checking that both resolve every name identically
+//
+// Usage: symbol_resolution [locals = 4096] [statements = 32768] [runs = 5]
+
+static std::string variable_name(std::size_t idx) {
+  return "v" + std::to_string(idx);
+}
+
+static std::pair<std::size_t, std::size_t> statement_operands(std::size_t idx, std::size_t locals) {
+  return {idx % locals, (idx * 7 + 1) % locals};
+}
+
+static std::string generate_source(std::size_t locals, std::size_t statements) {
+  std::string source = "{\n";
+  for (std::size_t idx = 0; idx < locals; ++idx)
+    source += "let " + variable_name(idx) + ": int = " + std::to_string(idx) + ";\n";
+  for (std::size_t idx = 0; idx < statements; ++idx) {
+    auto [lhs, rhs] = statement_operands(idx, locals);
+    source += "apply " + variable_name(lhs) + " = @add(" + variable_name(rhs) + ", " + std::to_string(idx) + ");\n";
+  }
+  source += "0\n}\n";
+  return source;
+}
+
+// Replays the analyzer's declarations and lookups for the generated script, every operand in a scope of its own
+template<typename T>
+static std::vector<std::size_t> resolve(const std::vector<std::string> &names, std::size_t statements) {
+  std::vector<std::size_t> ref_ids{};
+  ref_ids.reserve(statements * 2);
+  T symbols{};
+  symbols.enter_scope();
+  for (std::size_t idx = 0; idx < names.size(); ++idx)
+    symbols.declare(names[idx], idx);
+  for (std::size_t idx = 0; idx < statements; ++idx) {
+    auto [lhs, rhs] = statement_operands(idx, names.size());
+    for (auto operand: {lhs, rhs}) {
+      symbols.enter_scope();
+      ref_ids.push_back(symbols.lookup(names[operand]));
+      symbols.leave_scope();
+    }
+  }
+  symbols.leave_scope();
+  return ref_ids;
+}
+
+int main(int argc, char **argv) {
+  std::size_t locals = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096;
+  std::size_t statements = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 32768;
+  int runs = argc > 3 ? std::atoi(argv[3]) : 5;
+
+  if (locals == 0) {
+    std::cerr << "At least one local is required" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto source = generate_source(locals, statements);
+  std::vector<Token> tokens{};
+  ExpressionTree expression{};
+  AnalyzedExpressionTree analyzed_expression{};
+  auto lexer_seconds = fastest_run(runs, [&]() { tokens = Lexer{source}.tokenize(); });
+  auto parser_seconds = fastest_run(runs, [&]() { expression = Parser{source, tokens}.parse(); });
+  auto analyzer_seconds = fastest_run(runs, [&]() { analyzed_expression = Analyzer{expression}.analyze(); });
+
+  std::vector<std::string> names{};
+  for (std::size_t idx = 0; idx < locals; ++idx)
+    names.push_back(variable_name(idx));
+  std::vector<std::size_t> reference_ref_ids{}, ref_ids{};
+  auto reference_seconds = fastest_run(runs, [&]() {
+    reference_ref_ids = resolve<ReferenceSymbolTable>(names, statements);
+  });
+  auto hashed_seconds = fastest_run(runs, [&]() { ref_ids = resolve<SymbolTable>(names, statements); });
+
+  if (reference_ref_ids != ref_ids) {
+    std::cerr << "Symbol tables disagree on the generated source" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Source: " << locals << " locals, " << statements << " statements, " << ref_ids.size()
+            << " references, best of " << runs << " runs" << std::endl;
+  std::cout << std::left << std::fixed << std::setprecision(3) << std::setw(12) << "stage" << "ms" << std::endl;
+  std::cout << std::setw(12) << "lexer" << lexer_seconds * 1000 << std::endl;
+  std::cout << std::setw(12) << "parser" << parser_seconds * 1000 << std::endl;
+  std::cout << std::setw(12) << "analyzer" << analyzer_seconds * 1000 << std::endl;
+  std::cout << std::endl << std::setw(12) << "resolution" << "ms" << std::endl;
+  std::cout << std::setw(12) << "reference" << reference_seconds * 1000 << std::endl;
+  std::cout << std::setw(12) << "hashed" << hashed_seconds * 1000 << std::endl;
+  std::cout << "Speedup: " << std::setprecision(2) << reference_seconds / hashed_seconds << "x" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "amsl.hpp"
+#include "measure.hpp"
+
+// Executes a script summing a range through a self-recursive function whose recursive call is in tail position, with
+// the recursion depth bound by the host, and the same sum written as a C++ loop. Every level of the recursion records
+// how deep the stack is, fails if the results differ or if recursing `depth` levels takes more stack than recursing
+// one level
+//
+// Usage: tail_calls [depth = 1000000] [runs = 100]
+
+static std::uintptr_t lowest_address = UINTPTR_MAX;
+
+[[gnu::noinline]] static void record_stack_depth() {
+  volatile char marker = 0;
+  lowest_address = std::min(lowest_address, reinterpret_cast<std::uintptr_t>(&marker));
+}
+
+int main(int argc, char **argv) {
+  long depth = argc > 1 ? std::atol(argv[1]) : 1000000;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 100;
+
+  long levels = 0, total = 0;
+  auto functions = HostFunctions{host_function<"probe">([]() { record_stack_depth(); })};
+  auto variables = HostVariables{host_variable<"levels">(levels), host_variable<"total">(total)};
+  // Lowest stack address seen while recursing `recursion_depth` levels
+  auto stack_low_water = [&](long recursion_depth) {
+    levels = recursion_depth;
+    lowest_address = UINTPTR_MAX;
+    AMSL{}.execute<R"({
+    let sum = [(n: int64, acc: int64) -> int64 {
+        @probe();
+        if (@eq(n, 0)) {
+            acc
+        } else {
+            @sum(@sub(n, 1), @add(acc, n))
+        }
+    }];
+    apply total = @sum(levels, 0);
+    0
+})">(functions, variables);
+    return lowest_address;
+  };
+
+  auto shallow = stack_low_water(1);
+  auto deep = stack_low_water(depth);
+  if (total != depth * (depth + 1) / 2) {
+    std::cerr << "Script result is wrong" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Depth: " << depth << ", runs: " << runs << std::endl;
+  std::cout << "Stack below one level: " << (shallow - deep) << " bytes" << std::endl;
+  if (deep < shallow) {
+    std::cerr << "Stack grows with the recursion depth" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  long script_total = 0, native_total = 0;
+  auto script_ns = measure(runs, depth, [&](int run) {
+    levels = depth + run % 2;
+    AMSL{}.execute<R"({
+    let sum = [(n: int64, acc: int64) -> int64 {
+        if (@eq(n, 0)) { acc } else { @sum(@sub(n, 1), @add(acc, n)) }
+    }];
+    apply total = @sum(levels, 0);
+    0
+})">(HostFunctions{}, variables);
+    script_total += total;
+  }) * 1e9;
+  auto native_ns = measure(runs, depth, [&](int run) {
+    long bound = depth + run % 2, sum = 0;
+    for (long n = bound; n != 0; --n)
+      sum += n;
+    native_total += sum;
+  }) * 1e9;
+  if (script_total != native_total) {
+    std::cerr << "Script and native results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Tail recursion, script: " << script_ns << " ns per level" << std::endl;
+  std::cout << "Loop, native: " << native_ns << " ns per level" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -11,30 +11,33 @@
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "analyzer.hpp"
+#include "optimizer.hpp"
 
 using namespace std::literals;
 
 class AMSL {
 public:
-  template<string_t source_code>
-  AMSL_INLINE auto execute() {
-    return generate_executor<source_code>()();
+  // `functions` are the host functions the script may call besides the builtin ones, `variables` are the host
+  // variables the script may use without declaring them
+  template<string_t source_code, typename Functions = HostFunctions<>, typename Variables = HostVariables<>>
+  AMSL_INLINE auto execute(Functions &&functions = {}, Variables &&variables = {}) {
+    return generate_executor<source_code>()(functions, variables);
   }
 
 private:
   template<string_t source_code>
   consteval static auto generate_executor() {
     constexpr auto generator = []() {
-      auto tokens = Lexer{source_code.sv()}.tokenize();
-      auto expression = Parser{tokens}.parse();
+      auto source = source_code.sv();
+      auto tokens = Lexer{source}.tokenize();
+      auto expression = Parser{source, tokens}.parse();
       auto analyzer_expression = Analyzer{expression}.analyze();
-      return encode_to_bytes(analyzer_expression);
+      auto optimized_expression = Optimizer{analyzer_expression}.optimize();
+      return encode_to_bytes(optimized_expression);
     };
-    static constexpr auto byte_array = to_byte_array<max_code_size>(generator);
-    return Executor<typename Compiler<byte_array.begin()>::compiled>{};
+    static constexpr auto byte_array = to_byte_array(generator);
+    return Executor<typename ProgramCompiler<byte_array.begin()>::compiled>{};
   }
-
-  static constexpr std::size_t max_code_size = 10 * 1024 * 1024; // 10 MB
 };
 
 #endif // AMSL_AMSL_HPP
@@ -1,214 +1,360 @@
 #ifndef AMSL_ANALYZED_EXPRESSION_HPP
 #define AMSL_ANALYZED_EXPRESSION_HPP
 
-#include <utility>
-#include <vector>
-#include <optional>
 #include <string>
-#include "ptr_wrapper.hpp"
+#include <string_view>
+#include "node_arena.hpp"
 #include "bytes.hpp"
-#include "encodable.hpp"
 #include "encoder.hpp"
+#include "utils.hpp"
 
-class AnalyzedExpression : public Encodable {
-public:
-  constexpr virtual ~AnalyzedExpression() = default;
+// Every node kind is encoded as its `opcode` followed by its fields (child nodes are encoded in place, strings as
+// their index in the string pool)
 
-  constexpr void encode(Bytes &bytes) const override {
-    ::encode(bytes, identifier());
-    encode_to_bytes(bytes);
-  }
+struct AnalyzedExpressionList {
+  static constexpr Opcode opcode{Opcode::EXPRESSION_LIST};
 
-  [[nodiscard]] constexpr virtual std::string as_string() const = 0;
+  NodeRange expressions{};
+};
 
-protected:
-  [[nodiscard]] constexpr virtual std::byte identifier() const = 0;
+struct AnalyzedFunctionCallExpression {
+  static constexpr Opcode opcode{Opcode::FUNCTION_CALL};
 
-  constexpr virtual void encode_to_bytes(Bytes &bytes) const = 0;
+  std::string_view name{};
+  NodeRange parameters{};
 };
 
-class AnalyzedExpressionList : public AnalyzedExpression {
-public:
-  std::vector<ptr_wrapper<AnalyzedExpression>> expressions;
-
-  constexpr explicit AnalyzedExpressionList(std::vector<ptr_wrapper<AnalyzedExpression>> &&expressions = {})
-    : expressions{std::move(expressions)} {
-  }
+struct AnalyzedVariableDeclarationExpression {
+  static constexpr Opcode opcode{Opcode::VARIABLE_DECLARATION};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    std::string str = "AnalyzedExpressionList(expressions=[";
-    for (std::size_t idx = 0; idx < expressions.size(); ++idx) {
-      if (idx)
-        str += ", ";
-      str += expressions[idx]->as_string();
-    }
-    return str + "])";
-  }
+  std::string_view type{};
+  std::size_t ref_id{};
+};
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{0}; }
+struct AnalyzedVariableDeclarationWithInitializerExpression {
+  static constexpr Opcode opcode{Opcode::VARIABLE_DECLARATION_WITH_INITIALIZER};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, expressions);
-  }
+  std::string_view type{};
+  std::size_t ref_id{};
+  NodeIndex initializer{no_node};
 };
 
-class AnalyzedFunctionCallExpression : public AnalyzedExpression {
-public:
-  std::string name;
-  std::vector<ptr_wrapper<AnalyzedExpression>> parameters;
-
-  constexpr explicit AnalyzedFunctionCallExpression(std::string name,
-                                                    std::vector<ptr_wrapper<AnalyzedExpression>> &&parameters = {})
-    : name{name}, parameters{std::move(parameters)} {}
+struct AnalyzedVariableDeclarationWithInitializerAutoTypeExpression {
+  static constexpr Opcode opcode{Opcode::VARIABLE_DECLARATION_WITH_INITIALIZER_AUTO_TYPE};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    std::string str = "AnalyzedFunctionCallExpression(name='" + name + "', parameters=[";
-    for (std::size_t idx = 0; idx < parameters.size(); ++idx) {
-      if (idx)
-        str += ", ";
-      str += parameters[idx]->as_string();
-    }
-    return str + "])";
-  }
+  std::size_t ref_id{};
+  NodeIndex initializer{no_node};
+};
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{1}; }
+struct AnalyzedVariableExpression {
+  static constexpr Opcode opcode{Opcode::VARIABLE};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, name);
-    ::encode(bytes, parameters);
-  }
+  std::size_t ref_id{};
 };
 
-class AnalyzedVariableDeclarationExpression : public AnalyzedExpression {
-public:
-  std::string type;
+struct AnalyzedAssignmentExpression {
+  static constexpr Opcode opcode{Opcode::ASSIGNMENT};
 
-  constexpr explicit AnalyzedVariableDeclarationExpression(std::string type)
-    : type{type} {}
+  NodeIndex lhs{no_node};
+  NodeIndex rhs{no_node};
+};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "AnalyzedVariableDeclarationExpression(type='" + type + "')";
-  }
+template<typename T>
+struct AnalyzedLiteralExpression;
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{2}; }
+template<>
+struct AnalyzedLiteralExpression<int> {
+  static constexpr Opcode opcode{Opcode::INT_LITERAL};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, type);
-  }
+  int value{};
 };
 
-class AnalyzedVariableDeclarationWithInitializerExpression : public AnalyzedExpression {
-public:
-  std::string type;
-  ptr_wrapper<AnalyzedExpression> initializer;
-
-  constexpr explicit AnalyzedVariableDeclarationWithInitializerExpression(std::string type,
-                                                                          ptr_wrapper<AnalyzedExpression> &&initializer)
-    : type{type}, initializer{std::move(initializer)} {}
+template<>
+struct AnalyzedLiteralExpression<EscapedString> {
+  static constexpr Opcode opcode{Opcode::STRING_LITERAL};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "AnalyzedVariableDeclarationWithInitializerExpression(type='" + type + "', initializer=" +
-           initializer->as_string() + ")";
-  }
+  EscapedString value{};
+};
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{3}; }
+// Produced only by constant folding, the language itself has no floating point literals
+template<>
+struct AnalyzedLiteralExpression<double> {
+  static constexpr Opcode opcode{Opcode::DOUBLE_LITERAL};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, type);
-    ::encode(bytes, initializer);
-  }
+  double value{};
 };
 
-class AnalyzedVariableDeclarationWithInitializerAutoTypeExpression : public AnalyzedExpression {
-public:
-  ptr_wrapper<AnalyzedExpression> initializer;
+// Produced only by constant folding of comparisons
+template<>
+struct AnalyzedLiteralExpression<bool> {
+  static constexpr Opcode opcode{Opcode::BOOL_LITERAL};
 
-  constexpr explicit AnalyzedVariableDeclarationWithInitializerAutoTypeExpression(
-    ptr_wrapper<AnalyzedExpression> &&initializer)
-    : initializer{std::move(initializer)} {}
-
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "AnalyzedVariableDeclarationWithInitializerAutoTypeExpression(initializer=" +
-           initializer->as_string() + ")";
-  }
+  bool value{};
+};
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{4}; }
+// Variable the script does not declare, bound by the embedding code when the script is executed
+struct AnalyzedHostVariableExpression {
+  static constexpr Opcode opcode{Opcode::HOST_VARIABLE};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, initializer);
-  }
+  std::string_view name{};
 };
 
-class AnalyzedVariableExpression : public AnalyzedExpression {
-public:
-  std::size_t ref_id;
-
-  constexpr explicit AnalyzedVariableExpression(std::size_t ref_id) : ref_id{ref_id} {}
+// Last read of a local, its value is moved out of the frame. Produced by the last pass of the optimizer only
+struct AnalyzedMovedVariableExpression {
+  static constexpr Opcode opcode{Opcode::MOVED_VARIABLE};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "AnalyzedVariableExpression(ref_id=" + int_to_string(ref_id) + ")";
-  }
+  std::size_t ref_id{};
+};
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{5}; }
+struct AnalyzedWhileExpression {
+  static constexpr Opcode opcode{Opcode::WHILE};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, ref_id);
-  }
+  NodeIndex condition{no_node};
+  NodeIndex body{no_node};
 };
 
-class AnalyzedAssignmentExpression : public AnalyzedExpression {
-public:
-  ptr_wrapper<AnalyzedExpression> lhs;
-  ptr_wrapper<AnalyzedExpression> rhs;
+// Declares the loop variable `ref_id` in a scope of its own holding the body, the bounds are evaluated once before it
+struct AnalyzedForExpression {
+  static constexpr Opcode opcode{Opcode::FOR};
 
-  constexpr explicit AnalyzedAssignmentExpression(ptr_wrapper<AnalyzedExpression> &&lhs,
-                                                  ptr_wrapper<AnalyzedExpression> &&rhs) : lhs{std::move(lhs)},
-                                                                                           rhs{std::move(rhs)} {}
+  std::size_t ref_id{};
+  NodeIndex begin{no_node};
+  NodeIndex end{no_node};
+  NodeIndex body{no_node};
+};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "AnalyzedAssignmentExpression(lhs=" + lhs->as_string() + ", rhs=" + rhs->as_string() + ")";
-  }
+// A missing else branch is an empty expression list
+struct AnalyzedIfExpression {
+  static constexpr Opcode opcode{Opcode::IF};
 
-protected:
-  [[nodiscard]] constexpr std::byte identifier() const override { return std::byte{6}; }
+  NodeIndex condition{no_node};
+  NodeIndex then_branch{no_node};
+  NodeIndex else_branch{no_node};
+};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, lhs);
-    ::encode(bytes, rhs);
-  }
+// Function of the script called by `name`, with a frame of `size` variables of its own that starts with the
+// parameters (declarations, the type is empty when it is taken from the argument). An empty return type is inferred
+struct AnalyzedFunctionExpression {
+  static constexpr Opcode opcode{Opcode::FUNCTION};
+
+  std::string_view name{};
+  std::string_view return_type{};
+  NodeRange parameters{};
+  std::size_t size{};
+  NodeIndex body{no_node};
 };
 
-template<typename T>
-class AnalyzedLiteralExpression : public AnalyzedExpression {
-public:
-  T value;
+// Call of the enclosing function in tail position, made by the analyzer: the arguments replace the parameters and the
+// function starts over in the same frame
+struct AnalyzedTailCallExpression {
+  static constexpr Opcode opcode{Opcode::TAIL_CALL};
 
-  constexpr explicit AnalyzedLiteralExpression(const T &value) : value{value} {}
+  NodeRange arguments{};
+};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    if constexpr (std::is_same_v<T, int>)
-      return std::string{"AnalyzedLiteralExpression(value="} + int_to_string(value) + ")";
-    else
-      return std::string{"AnalyzedLiteralExpression(value='"} + value + "')";
-  }
+struct AnalyzedFrameExpression {
+  static constexpr Opcode opcode{Opcode::FRAME};
 
-protected:
-  [[nodiscard]] constexpr std::byte
-  identifier() const override {
-    if constexpr (std::is_same_v<T, int>)
-      return std::byte{7};
-    else if constexpr (std::is_same_v<T, std::string>)
-      return std::byte{8};
-  }
+  std::size_t size{};
+  NodeIndex body{no_node};
+};
 
-  constexpr void encode_to_bytes(Bytes &bytes) const override {
-    ::encode(bytes, value);
+using AnalyzedExpressionTree = NodeArena<AnalyzedExpressionList, AnalyzedFunctionCallExpression,
+  AnalyzedVariableDeclarationExpression, AnalyzedVariableDeclarationWithInitializerExpression,
+  AnalyzedVariableDeclarationWithInitializerAutoTypeExpression, AnalyzedVariableExpression,
+  AnalyzedAssignmentExpression, AnalyzedLiteralExpression<int>, AnalyzedLiteralExpression<EscapedString>,
+  AnalyzedFrameExpression, AnalyzedLiteralExpression<double>, AnalyzedHostVariableExpression,
+  AnalyzedMovedVariableExpression, AnalyzedWhileExpression, AnalyzedForExpression,
+  AnalyzedIfExpression, AnalyzedLiteralExpression<bool>, AnalyzedFunctionExpression, AnalyzedTailCallExpression>;
+
+constexpr std::string as_string(const AnalyzedExpressionTree &tree, NodeIndex index);
+
+constexpr std::string as_string(const AnalyzedExpressionTree &tree, std::span<const NodeIndex> indices) {
+  std::string str{};
+  for (std::size_t idx = 0; idx < indices.size(); ++idx) {
+    if (idx)
+      str += ", ";
+    str += as_string(tree, indices[idx]);
+  }
+  return str;
+}
+
+constexpr std::string as_string(const AnalyzedExpressionTree &tree, NodeIndex index) {
+  return tree.visit(index, Overload{
+    [&tree](const AnalyzedExpressionList &node) {
+      return "AnalyzedExpressionList(expressions=[" + as_string(tree, tree[node.expressions]) + "])";
+    },
+    [&tree](const AnalyzedFunctionCallExpression &node) {
+      return "AnalyzedFunctionCallExpression(name='" + std::string{node.name} + "', parameters=[" +
+             as_string(tree, tree[node.parameters]) + "])";
+    },
+    [](const AnalyzedVariableDeclarationExpression &node) {
+      return "AnalyzedVariableDeclarationExpression(type='" + std::string{node.type} + "', ref_id=" +
+             int_to_string(node.ref_id) + ")";
+    },
+    [&tree](const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+      return "AnalyzedVariableDeclarationWithInitializerExpression(type='" + std::string{node.type} + "', ref_id=" +
+             int_to_string(node.ref_id) + ", initializer=" + as_string(tree, node.initializer) + ")";
+    },
+    [&tree](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+      return "AnalyzedVariableDeclarationWithInitializerAutoTypeExpression(ref_id=" + int_to_string(node.ref_id) +
+             ", initializer=" + as_string(tree, node.initializer) + ")";
+    },
+    [](const AnalyzedVariableExpression &node) {
+      return "AnalyzedVariableExpression(ref_id=" + int_to_string(node.ref_id) + ")";
+    },
+    [&tree](const AnalyzedAssignmentExpression &node) {
+      return "AnalyzedAssignmentExpression(lhs=" + as_string(tree, node.lhs) + ", rhs=" + as_string(tree, node.rhs) +
+             ")";
+    },
+    [](const AnalyzedLiteralExpression<int> &node) {
+      return "AnalyzedLiteralExpression(value=" + int_to_string(node.value) + ")";
+    },
+    [](const AnalyzedLiteralExpression<EscapedString> &node) {
+      return "AnalyzedLiteralExpression(value='" + unescape(node.value.text) + "')";
+    },
+    [](const AnalyzedLiteralExpression<double> &node) {
+      return "AnalyzedLiteralExpression(value=" + double_to_string(node.value) + ")";
+    },
+    [](const AnalyzedLiteralExpression<bool> &node) {
+      return std::string{"AnalyzedLiteralExpression(value="} + (node.value ? "true" : "false") + ")";
+    },
+    [&tree](const AnalyzedFrameExpression &node) {
+      return "AnalyzedFrameExpression(size=" + int_to_string(node.size) + ", body=" + as_string(tree, node.body) +
+             ")";
+    },
+    [](const AnalyzedHostVariableExpression &node) {
+      return "AnalyzedHostVariableExpression(name='" + std::string{node.name} + "')";
+    },
+    [](const AnalyzedMovedVariableExpression &node) {
+      return "AnalyzedMovedVariableExpression(ref_id=" + int_to_string(node.ref_id) + ")";
+    },
+    [&tree](const AnalyzedWhileExpression &node) {
+      return "AnalyzedWhileExpression(condition=" + as_string(tree, node.condition) + ", body=" +
+             as_string(tree, node.body) + ")";
+    },
+    [&tree](const AnalyzedForExpression &node) {
+      return "AnalyzedForExpression(ref_id=" + int_to_string(node.ref_id) + ", begin=" + as_string(tree, node.begin) +
+             ", end=" + as_string(tree, node.end) + ", body=" + as_string(tree, node.body) + ")";
+    },
+    [&tree](const AnalyzedIfExpression &node) {
+      return "AnalyzedIfExpression(condition=" + as_string(tree, node.condition) + ", then_branch=" +
+             as_string(tree, node.then_branch) + ", else_branch=" + as_string(tree, node.else_branch) + ")";
+    },
+    [&tree](const AnalyzedFunctionExpression &node) {
+      return "AnalyzedFunctionExpression(name='" + std::string{node.name} + "', return_type='" +
+             std::string{node.return_type} + "', parameters=[" + as_string(tree, tree[node.parameters]) + "], size=" +
+             int_to_string(node.size) + ", body=" + as_string(tree, node.body) + ")";
+    },
+    [&tree](const AnalyzedTailCallExpression &node) {
+      return "AnalyzedTailCallExpression(arguments=[" + as_string(tree, tree[node.arguments]) + "])";
+    }
+  });
+}
+
+constexpr std::string as_string(const AnalyzedExpressionTree &tree) {
+  return as_string(tree, tree.root);
+}
+
+constexpr void encode(Bytes &bytes, StringPool &pool, const AnalyzedExpressionTree &tree, NodeIndex index);
+
+constexpr void encode(Bytes &bytes, StringPool &pool, const AnalyzedExpressionTree &tree,
+                      std::span<const NodeIndex> indices) {
+  ::encode(bytes, indices.size());
+  for (auto index: indices)
+    encode(bytes, pool, tree, index);
+}
+
+constexpr void encode(Bytes &bytes, StringPool &pool, const AnalyzedExpressionTree &tree, NodeIndex index) {
+  tree.visit(index, [&bytes](const auto &node) { ::encode(bytes, node.opcode); });
+  tree.visit(index, Overload{
+    [&bytes, &pool, &tree](const AnalyzedExpressionList &node) {
+      encode(bytes, pool, tree, tree[node.expressions]);
+    },
+    [&bytes, &pool, &tree](const AnalyzedFunctionCallExpression &node) {
+      ::encode(bytes, pool.intern(node.name));
+      encode(bytes, pool, tree, tree[node.parameters]);
+    },
+    [&bytes, &pool](const AnalyzedVariableDeclarationExpression &node) {
+      ::encode(bytes, pool.intern(node.type));
+      ::encode(bytes, node.ref_id);
+    },
+    [&bytes, &pool, &tree](const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+      ::encode(bytes, pool.intern(node.type));
+      ::encode(bytes, node.ref_id);
+      encode(bytes, pool, tree, node.initializer);
+    },
+    [&bytes, &pool, &tree](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+      ::encode(bytes, node.ref_id);
+      encode(bytes, pool, tree, node.initializer);
+    },
+    [&bytes](const AnalyzedVariableExpression &node) {
+      ::encode(bytes, node.ref_id);
+    },
+    [&bytes, &pool, &tree](const AnalyzedAssignmentExpression &node) {
+      encode(bytes, pool, tree, node.lhs);
+      encode(bytes, pool, tree, node.rhs);
+    },
+    [&bytes](const AnalyzedLiteralExpression<int> &node) {
+      ::encode(bytes, node.value);
+    },
+    [&bytes, &pool](const AnalyzedLiteralExpression<EscapedString> &node) {
+      ::encode(bytes, pool.intern(node.value));
+    },
+    [&bytes](const AnalyzedLiteralExpression<double> &node) {
+      ::encode(bytes, node.value);
+    },
+    [&bytes](const AnalyzedLiteralExpression<bool> &node) {
+      ::encode(bytes, node.value);
+    },
+    [&bytes, &pool, &tree](const AnalyzedFrameExpression &node) {
+      ::encode(bytes, node.size);
+      encode(bytes, pool, tree, node.body);
+    },
+    [&bytes, &pool](const AnalyzedHostVariableExpression &node) {
+      ::encode(bytes, pool.intern(node.name));
+    },
+    [&bytes](const AnalyzedMovedVariableExpression &node) {
+      ::encode(bytes, node.ref_id);
+    },
+    [&bytes, &pool, &tree](const AnalyzedWhileExpression &node) {
+      encode(bytes, pool, tree, node.condition);
+      encode(bytes, pool, tree, node.body);
+    },
+    [&bytes, &pool, &tree](const AnalyzedForExpression &node) {
+      ::encode(bytes, node.ref_id);
+      encode(bytes, pool, tree, node.begin);
+      encode(bytes, pool, tree, node.end);
+      encode(bytes, pool, tree, node.body);
+    },
+    [&bytes, &pool, &tree](const AnalyzedIfExpression &node) {
+      encode(bytes, pool, tree, node.condition);
+      encode(bytes, pool, tree, node.then_branch);
+      encode(bytes, pool, tree, node.else_branch);
+    },
+    [&bytes, &pool, &tree](const AnalyzedFunctionExpression &node) {
+      ::encode(bytes, pool.intern(node.name));
+      ::encode(bytes, pool.intern(node.return_type));
+      encode(bytes, pool, tree, tree[node.parameters]);
+      ::encode(bytes, node.size);
+      encode(bytes, pool, tree, node.body);
+    },
+    [&bytes, &pool, &tree](const AnalyzedTailCallExpression &node) {
+      encode(bytes, pool, tree, tree[node.arguments]);
+    }
+  });
+}
+
+// The string pool precedes the nodes, so nodes are encoded first to collect it
+template<>
+struct Encoder<AnalyzedExpressionTree> {
+  static constexpr void encode(Bytes &bytes, const AnalyzedExpressionTree &tree) {
+    StringPool pool{};
+    Bytes nodes{};
+    ::encode(nodes, pool, tree, tree.root);
+    ::encode(bytes, bytecode_version);
+    ::encode(bytes, pool);
+    bytes.insert(bytes.end(), nodes.begin(), nodes.end());
   }
 };
 
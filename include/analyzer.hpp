@@ -1,20 +1,186 @@
 #ifndef AMSL_ANALYZER_HPP
 #define AMSL_ANALYZER_HPP
 
+#include <string_view>
 #include "expression.hpp"
 #include "analyzed_expression.hpp"
+#include "symbol_table.hpp"
+
+struct AnalyzerState {
+  SymbolTable symbols{};
+  std::size_t frame_size{};
+  // First ref_id of the innermost function, locals declared before it belong to enclosing frames
+  std::size_t frame_base{};
+  AnalyzedExpressionTree tree{};
+  PendingChildren pending_children{};
+
+  // Every declaration gets its own frame slot, nested blocks are laid out in the same frame after the outer ones
+  constexpr std::size_t declare_variable(std::string_view name) {
+    auto ref_id = frame_size++;
+    symbols.declare(name, ref_id);
+    return ref_id;
+  }
+
+  // Functions do not capture the locals of enclosing frames, names bound to them are looked up as host variables
+  constexpr std::size_t get_variable_ref_id(std::string_view name) {
+    auto ref_id = symbols.lookup(name);
+    return ref_id != SymbolTable::unbound && ref_id >= frame_base ? ref_id : SymbolTable::unbound;
+  }
+};
 
 class Analyzer {
 public:
-  constexpr explicit Analyzer(const ptr_wrapper<Expression> &expression) : root{expression} {}
+  constexpr explicit Analyzer(const ExpressionTree &expression) : source{expression} {}
 
-  constexpr ptr_wrapper<AnalyzedExpression> analyze() {
-    AnalyzerState state;
-    return root->analyze(state);
+  constexpr AnalyzedExpressionTree analyze() {
+    state = AnalyzerState{};
+    // One analyzed node per parsed node plus the frame
+    state.tree.reserve(source.nodes.size() + 1);
+    state.pending_children.reserve(source.nodes.size());
+    auto body = analyze(source.root);
+    state.tree.root = state.tree.add(AnalyzedFrameExpression{state.frame_size, body});
+    return std::move(state.tree);
   }
 
 private:
-  const ptr_wrapper<Expression> &root;
+  constexpr NodeIndex analyze(NodeIndex index) {
+    return source.visit(index, [this](const auto &node) { return analyze(node); });
+  }
+
+  // Analyzes `index` in a scope of its own, so that declarations inside of it are not visible outside
+  constexpr NodeIndex analyze_scoped(NodeIndex index) {
+    state.symbols.enter_scope();
+    auto analyzed = analyze(index);
+    state.symbols.leave_scope();
+    return analyzed;
+  }
+
+  constexpr NodeIndex analyze(const ExpressionList &node) {
+    auto mark = state.pending_children.mark();
+    state.symbols.enter_scope();
+    for (auto expression: source[node.expressions])
+      state.pending_children.push(analyze(expression));
+    state.symbols.leave_scope();
+    return state.tree.add(AnalyzedExpressionList{state.pending_children.pop(state.tree, mark)});
+  }
+
+  constexpr NodeIndex analyze(const FunctionCallExpression &node) {
+    auto mark = state.pending_children.mark();
+    for (auto parameter: source[node.parameters])
+      state.pending_children.push(analyze_scoped(parameter));
+    return state.tree.add(AnalyzedFunctionCallExpression{node.name, state.pending_children.pop(state.tree, mark)});
+  }
+
+  constexpr NodeIndex analyze(const VariableDeclarationExpression &node) {
+    return state.tree.add(AnalyzedVariableDeclarationExpression{node.type, state.declare_variable(node.name)});
+  }
+
+  // A function literal declares a function instead of a variable, the declared (function) type only documents it
+  constexpr NodeIndex analyze(const VariableDeclarationWithInitializerExpression &node) {
+    if (auto *function = std::get_if<FunctionExpression>(&source[node.initializer]))
+      return analyze_function(node.name, *function);
+    auto initializer = analyze_scoped(node.initializer);
+    return state.tree.add(AnalyzedVariableDeclarationWithInitializerExpression{
+      node.type, state.declare_variable(node.name), initializer});
+  }
+
+  constexpr NodeIndex analyze(const VariableDeclarationWithInitializerAutoTypeExpression &node) {
+    if (auto *function = std::get_if<FunctionExpression>(&source[node.initializer]))
+      return analyze_function(node.name, *function);
+    auto initializer = analyze_scoped(node.initializer);
+    return state.tree.add(AnalyzedVariableDeclarationWithInitializerAutoTypeExpression{
+      state.declare_variable(node.name), initializer});
+  }
+
+  // Names that are not declared by the script refer to host variables
+  constexpr NodeIndex analyze(const VariableExpression &node) {
+    auto ref_id = state.get_variable_ref_id(node.name);
+    if (ref_id == SymbolTable::unbound)
+      return state.tree.add(AnalyzedHostVariableExpression{node.name});
+    return state.tree.add(AnalyzedVariableExpression{ref_id});
+  }
+
+  constexpr NodeIndex analyze(const AssignmentExpression &node) {
+    auto lhs = analyze_scoped(node.lhs);
+    auto rhs = analyze_scoped(node.rhs);
+    return state.tree.add(AnalyzedAssignmentExpression{lhs, rhs});
+  }
+
+  constexpr NodeIndex analyze(const WhileExpression &node) {
+    auto condition = analyze_scoped(node.condition);
+    auto body = analyze_scoped(node.body);
+    return state.tree.add(AnalyzedWhileExpression{condition, body});
+  }
+
+  // The loop variable is visible in the body only, the bounds can not refer to it
+  constexpr NodeIndex analyze(const ForExpression &node) {
+    auto begin = analyze_scoped(node.begin);
+    auto end = analyze_scoped(node.end);
+    state.symbols.enter_scope();
+    auto ref_id = state.declare_variable(node.name);
+    auto body = analyze(node.body);
+    state.symbols.leave_scope();
+    return state.tree.add(AnalyzedForExpression{ref_id, begin, end, body});
+  }
+
+  constexpr NodeIndex analyze(const IfExpression &node) {
+    auto condition = analyze_scoped(node.condition);
+    auto then_branch = analyze_scoped(node.then_branch);
+    auto else_branch = node.else_branch != no_node ? analyze_scoped(node.else_branch)
+                                                   : state.tree.add(AnalyzedExpressionList{});
+    return state.tree.add(AnalyzedIfExpression{condition, then_branch, else_branch});
+  }
+
+  // Functions are called by the name they are declared with, a function literal that is not declared can not be called
+  constexpr NodeIndex analyze(const FunctionExpression &) {
+    return state.tree.add(AnalyzedExpressionList{});
+  }
+
+  // Parameters and locals of a function are numbered after everything declared before it, the frame compactor
+  // renumbers them from 0 in a frame of the function's own
+  constexpr NodeIndex analyze_function(std::string_view name, const FunctionExpression &node) {
+    auto enclosing_base = state.frame_base;
+    state.frame_base = state.frame_size;
+    state.symbols.enter_scope();
+    auto mark = state.pending_children.mark();
+    for (auto parameter: source[node.parameters]) {
+      const auto &declaration = std::get<VariableDeclarationExpression>(source[parameter]);
+      state.pending_children.push(state.tree.add(AnalyzedVariableDeclarationExpression{
+        declaration.type, state.declare_variable(declaration.name)}));
+    }
+    auto parameters = state.pending_children.pop(state.tree, mark);
+    auto body = analyze(node.body);
+    lower_tail_calls(name, parameters.size, body);
+    state.symbols.leave_scope();
+    auto size = state.frame_size - state.frame_base;
+    state.frame_base = enclosing_base;
+    return state.tree.add(AnalyzedFunctionExpression{name, node.return_type, parameters, size, body});
+  }
+
+  // Self calls in tail position (the value of the body, of the last expression of a list in tail position or of a
+  // branch of an if expression in tail position) become jumps back to the start of the function, so tail recursion
+  // runs in constant stack space
+  constexpr void lower_tail_calls(std::string_view name, std::size_t arity, NodeIndex index) {
+    auto &node = state.tree.nodes[index];
+    if (auto *list = std::get_if<AnalyzedExpressionList>(&node)) {
+      if (list->expressions.size)
+        lower_tail_calls(name, arity, state.tree[list->expressions].back());
+    } else if (auto *branch = std::get_if<AnalyzedIfExpression>(&node)) {
+      auto else_branch = branch->else_branch;
+      lower_tail_calls(name, arity, branch->then_branch);
+      lower_tail_calls(name, arity, else_branch);
+    } else if (auto *call = std::get_if<AnalyzedFunctionCallExpression>(&node);
+      call && call->name == name && call->parameters.size == arity)
+      node = AnalyzedTailCallExpression{call->parameters};
+  }
+
+  template<typename T>
+  constexpr NodeIndex analyze(const LiteralExpression<T> &node) {
+    return state.tree.add(AnalyzedLiteralExpression<T>{node.value});
+  }
+
+  const ExpressionTree &source;
+  AnalyzerState state{};
 };
 
 #endif // AMSL_ANALYZER_HPP
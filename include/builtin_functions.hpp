@@ -1,33 +1,88 @@
 #ifndef AMSL_BUILTIN_FUNCTIONS_HPP
 #define AMSL_BUILTIN_FUNCTIONS_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <thread>
+#include "output.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
 #include "string.hpp"
 #include "utils.hpp"
 
+// What calling a builtin function may do besides computing its result, from the weakest to the strongest effect
+enum class Effect {
+  // The result depends only on the arguments, calls can be folded, reused, reordered or dropped
+  PURE,
+  // Modifies the variables passed to it
+  WRITES_ARGUMENTS,
+  // Interacts with the environment (streams, clock, sleeping), calls are never moved, merged or dropped and nothing
+  // is moved across them
+  IO
+};
+
+// Every builtin function declares its `effect`
 template<string_t Name>
 struct BuiltinFunction;
 
 template<>
 struct BuiltinFunction<"print"> {
+  static constexpr Effect effect = Effect::IO;
+  // `@format` arguments are passed unformatted and written straight to the output sink
+  static constexpr bool writes_output = true;
+
   template<typename... Args>
   static constexpr void operator()(Args &&... args) {
-    (std::cout << ... << args);
+    auto &sink = output_sink();
+    (sink.write_value(args), ...);
   }
 };
 
 template<>
 struct BuiltinFunction<"println"> {
+  static constexpr Effect effect = Effect::IO;
+  // `@format` arguments are passed unformatted and written straight to the output sink
+  static constexpr bool writes_output = true;
+
   template<typename... Args>
   static constexpr void operator()(Args &&... args) {
-    (std::cout << ... << args) << std::endl;
+    auto &sink = output_sink();
+    (sink.write_value(args), ...);
+    sink.put('\n');
+  }
+};
+
+// Executed by its own executor, which parses the format string at compile time
+template<>
+struct BuiltinFunction<"format"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  template<typename... Args>
+  static std::string operator()(Args &&...) {
+    static_assert(sizeof...(Args) < 0, "The format string of @format must be a string literal");
+    return {};
+  }
+};
+
+// Writes out everything printed so far
+template<>
+struct BuiltinFunction<"flush"> {
+  static constexpr Effect effect = Effect::IO;
+
+  static void operator()() {
+    output_sink().flush();
   }
 };
 
 template<>
 struct BuiltinFunction<"squared"> {
+  static constexpr Effect effect = Effect::PURE;
+
   static constexpr auto operator()(auto value) {
     return value * value;
   }
@@ -35,6 +90,8 @@ struct BuiltinFunction<"squared"> {
 
 template<>
 struct BuiltinFunction<"inc"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
   static constexpr decltype(auto) operator()(auto &value) {
     return ++value;
   }
@@ -42,6 +99,8 @@ struct BuiltinFunction<"inc"> {
 
 template<>
 struct BuiltinFunction<"dec"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
   static constexpr decltype(auto) operator()(auto &value) {
     return --value;
   }
@@ -49,6 +108,8 @@ struct BuiltinFunction<"dec"> {
 
 template<>
 struct BuiltinFunction<"pinc"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
   static constexpr decltype(auto) operator()(auto &value) {
     return value++;
   }
@@ -56,6 +117,8 @@ struct BuiltinFunction<"pinc"> {
 
 template<>
 struct BuiltinFunction<"pdec"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
   static constexpr decltype(auto) operator()(auto &value) {
     return value--;
   }
@@ -63,41 +126,115 @@ struct BuiltinFunction<"pdec"> {
 
 template<>
 struct BuiltinFunction<"add"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  // Strings are appended to the buffer of `lhs`, which is moved in when it is the last read of a variable, a literal
+  // (a `std::string_view`) is copied into a new buffer first. Vectors are added lane-wise, a scalar operand is added to
+  // every lane
   static constexpr auto operator()(auto lhs, auto rhs) {
-    return lhs + rhs;
+    if constexpr (std::same_as<decltype(lhs), std::string_view> || std::same_as<decltype(rhs), std::string_view>) {
+      std::string result{std::move(lhs)};
+      result += rhs;
+      return result;
+    } else
+      return lane_operand<decltype(rhs)>(std::move(lhs)) + lane_operand<decltype(lhs)>(rhs);
   }
 };
 
 template<>
 struct BuiltinFunction<"sub"> {
+  static constexpr Effect effect = Effect::PURE;
+
   static constexpr auto operator()(auto lhs, auto rhs) {
-    return lhs - rhs;
+    return lane_operand<decltype(rhs)>(lhs) - lane_operand<decltype(lhs)>(rhs);
   }
 };
 
 template<>
 struct BuiltinFunction<"mul"> {
+  static constexpr Effect effect = Effect::PURE;
+
   static constexpr auto operator()(auto lhs, auto rhs) {
-    return lhs * rhs;
+    return lane_operand<decltype(rhs)>(lhs) * lane_operand<decltype(lhs)>(rhs);
   }
 };
 
 template<>
 struct BuiltinFunction<"div"> {
+  static constexpr Effect effect = Effect::PURE;
+
   static constexpr auto operator()(auto lhs, auto rhs) {
-    return lhs / rhs;
+    return lane_operand<decltype(rhs)>(lhs) / lane_operand<decltype(lhs)>(rhs);
   }
 };
 
 template<>
 struct BuiltinFunction<"pow"> {
+  static constexpr Effect effect = Effect::PURE;
+
   static constexpr auto operator()(auto value, auto power) {
     return std::pow(value, power);
   }
 };
 
+template<>
+struct BuiltinFunction<"lt"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr bool operator()(const auto &lhs, const auto &rhs) {
+    return lhs < rhs;
+  }
+};
+
+template<>
+struct BuiltinFunction<"le"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr bool operator()(const auto &lhs, const auto &rhs) {
+    return lhs <= rhs;
+  }
+};
+
+template<>
+struct BuiltinFunction<"gt"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr bool operator()(const auto &lhs, const auto &rhs) {
+    return lhs > rhs;
+  }
+};
+
+template<>
+struct BuiltinFunction<"ge"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr bool operator()(const auto &lhs, const auto &rhs) {
+    return lhs >= rhs;
+  }
+};
+
+template<>
+struct BuiltinFunction<"eq"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr bool operator()(const auto &lhs, const auto &rhs) {
+    return lhs == rhs;
+  }
+};
+
+template<>
+struct BuiltinFunction<"ne"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr bool operator()(const auto &lhs, const auto &rhs) {
+    return lhs != rhs;
+  }
+};
+
 template<>
 struct BuiltinFunction<"get_current_time"> {
+  static constexpr Effect effect = Effect::IO;
+
   static auto operator()() {
     return get_current_time_fenced();
   }
@@ -105,6 +242,8 @@ struct BuiltinFunction<"get_current_time"> {
 
 template<>
 struct BuiltinFunction<"get_millis"> {
+  static constexpr Effect effect = Effect::PURE;
+
   static auto operator()(auto value) {
     return to_ms(value);
   }
@@ -112,18 +251,205 @@ struct BuiltinFunction<"get_millis"> {
 
 template<>
 struct BuiltinFunction<"sleep"> {
+  static constexpr Effect effect = Effect::IO;
+
   static auto operator()(auto value) {
+    output_sink().flush();
     return std::this_thread::sleep_for(std::chrono::milliseconds{value});
   }
 };
 
 template<>
 struct BuiltinFunction<"readline"> {
+  static constexpr Effect effect = Effect::IO;
+
   static auto operator()() {
+    output_sink().flush();
     std::string str;
     std::getline(std::cin, str);
     return str;
   }
 };
 
+// Fills the lanes of `vector` with consecutive elements of `buffer` (a contiguous range of the lane type, a host
+// variable) starting at `offset`, the buffer needs not be aligned
+template<>
+struct BuiltinFunction<"load"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
+  template<SimdVector V>
+  static decltype(auto) operator()(V &vector, const auto &buffer, auto offset) {
+    static_assert(std::is_same_v<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(buffer))>>, lane_t<V>>,
+                  "Buffer elements have to be of the lane type");
+    std::memcpy(&vector, std::data(buffer) + offset, sizeof(V));
+    return vector;
+  }
+};
+
+// Writes the lanes of `vector` to consecutive elements of `buffer` starting at `offset`
+template<>
+struct BuiltinFunction<"store"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
+  template<SimdVector V>
+  static void operator()(auto &buffer, auto offset, const V &vector) {
+    static_assert(std::is_same_v<std::remove_pointer_t<decltype(std::data(buffer))>, lane_t<V>>,
+                  "Buffer elements have to be of the lane type and writable");
+    std::memcpy(std::data(buffer) + offset, &vector, sizeof(V));
+  }
+};
+
+// Sum of the lanes of a vector, added in lane order
+template<>
+struct BuiltinFunction<"hsum"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  template<SimdVector V>
+  static constexpr lane_t<V> operator()(const V &vector) {
+    return [&vector]<std::size_t... Idx>(std::index_sequence<Idx...>) {
+      return static_cast<lane_t<V>>((vector[Idx] + ...));
+    }(std::make_index_sequence<lane_count<V>>{});
+  }
+};
+
+// Vector whose lane i is the lane `indices[i]` (modulo the lane count) of `vector`, one index per lane
+template<>
+struct BuiltinFunction<"shuffle"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  template<SimdVector V, typename... Indices>
+  static constexpr V operator()(const V &vector, Indices... indices) {
+    static_assert(sizeof...(Indices) == lane_count<V>, "@shuffle takes one lane index per lane");
+    using mask_type = shuffle_mask_t<V>;
+    return __builtin_shuffle(vector, mask_type{static_cast<std::remove_cvref_t<decltype(mask_type{}[0])>>(indices)...});
+  }
+};
+
+// Number of elements of an array (or characters of a string)
+template<>
+struct BuiltinFunction<"size"> {
+  static constexpr Effect effect = Effect::PURE;
+
+  static constexpr std::int64_t operator()(const auto &array) {
+    return static_cast<std::int64_t>(std::size(array));
+  }
+};
+
+// New elements are value-initialized
+template<>
+struct BuiltinFunction<"resize"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
+  static constexpr void operator()(auto &array, auto size) {
+    array.resize(static_cast<std::size_t>(size));
+  }
+};
+
+// Element `index` of an array, it can be assigned to. The element of an array that is not a variable is returned by
+// value
+template<>
+struct BuiltinFunction<"at"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
+  template<typename Array>
+  static constexpr decltype(auto) operator()(Array &&array, auto index) {
+    if constexpr (std::is_lvalue_reference_v<Array>)
+      return array[static_cast<std::size_t>(index)];
+    else {
+      auto element = std::move(array[static_cast<std::size_t>(index)]);
+      return element;
+    }
+  }
+};
+
+// The array builtins take a function by its name (without `@`). Arrays of at least `ParallelConfig::threshold` elements
+// are split over several threads, the function is then called concurrently. Script functions that do I/O (`@println`
+// writing to the unsynchronized output sink), write host variables or call host or script functions are called by one
+// thread instead, host functions have to be safe to call concurrently
+
+// New array of the results of `function` for every element
+template<>
+struct BuiltinFunction<"map"> {
+  static constexpr Effect effect = Effect::IO;
+
+  static auto operator()(const auto &array, auto &&function) {
+    return parallel_map(array, function);
+  }
+};
+
+// `function(function(initial, first), second)...`, associative `function` when it returns the element type
+template<>
+struct BuiltinFunction<"reduce"> {
+  static constexpr Effect effect = Effect::IO;
+
+  static auto operator()(const auto &array, auto initial, auto &&function) {
+    return parallel_reduce(array, std::move(initial), function);
+  }
+};
+
+// Calls `function` with every element, host functions taking the element by reference can change it
+template<>
+struct BuiltinFunction<"for_each"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
+  static void operator()(auto &array, auto &&function) {
+    parallel_for_each(array, function);
+  }
+};
+
+// Sorts an array in place, in ascending order or by a function telling whether its first argument goes first
+template<>
+struct BuiltinFunction<"sort"> {
+  static constexpr Effect effect = Effect::WRITES_ARGUMENTS;
+
+  static void operator()(auto &array) {
+    std::less<> less{};
+    parallel_sort(array, less);
+  }
+
+  static void operator()(auto &array, auto &&less) {
+    parallel_sort(array, less);
+  }
+};
+
+struct BuiltinEffect {
+  std::string_view name{};
+  Effect effect{};
+};
+
+template<string_t Name>
+constexpr BuiltinEffect builtin_effect_of() {
+  return {std::string_view{Name.data.data(), Name.Size}, BuiltinFunction<Name>::effect};
+}
+
+inline constexpr BuiltinEffect builtin_effects[]{
+  builtin_effect_of<"print">(), builtin_effect_of<"println">(), builtin_effect_of<"format">(),
+  builtin_effect_of<"flush">(), builtin_effect_of<"squared">(), builtin_effect_of<"inc">(), builtin_effect_of<"dec">(),
+  builtin_effect_of<"pinc">(), builtin_effect_of<"pdec">(), builtin_effect_of<"add">(), builtin_effect_of<"sub">(),
+  builtin_effect_of<"mul">(), builtin_effect_of<"div">(), builtin_effect_of<"pow">(), builtin_effect_of<"lt">(),
+  builtin_effect_of<"le">(), builtin_effect_of<"gt">(), builtin_effect_of<"ge">(), builtin_effect_of<"eq">(),
+  builtin_effect_of<"ne">(), builtin_effect_of<"get_current_time">(), builtin_effect_of<"get_millis">(),
+  builtin_effect_of<"sleep">(), builtin_effect_of<"readline">(), builtin_effect_of<"load">(),
+  builtin_effect_of<"store">(), builtin_effect_of<"hsum">(), builtin_effect_of<"shuffle">(),
+  builtin_effect_of<"size">(), builtin_effect_of<"resize">(), builtin_effect_of<"at">(), builtin_effect_of<"map">(),
+  builtin_effect_of<"reduce">(), builtin_effect_of<"for_each">(), builtin_effect_of<"sort">()};
+
+constexpr bool is_builtin(std::string_view name) {
+  return std::ranges::any_of(builtin_effects, [name](const BuiltinEffect &builtin) { return builtin.name == name; });
+}
+
+// Effect of the builtin function called `name` as seen by the analyzed AST, unknown (host) functions are assumed to do
+// I/O
+constexpr Effect builtin_effect(std::string_view name) {
+  for (const auto &[builtin_name, effect]: builtin_effects)
+    if (builtin_name == name)
+      return effect;
+  return Effect::IO;
+}
+
+// Host functions may take their arguments by reference, so they are assumed to write them too
+constexpr bool may_write_arguments(std::string_view name) {
+  return builtin_effect(name) == Effect::WRITES_ARGUMENTS || !is_builtin(name);
+}
+
 #endif // AMSL_BUILTIN_FUNCTIONS_HPP
@@ -1,8 +1,35 @@
 #ifndef AMSL_BYTES_HPP
 #define AMSL_BYTES_HPP
 
+#include <cstdint>
 #include <vector>
 
 using Bytes = std::vector<std::byte>;
 
+// Encoded programs start with the version of the byte format they were encoded with
+inline constexpr std::byte bytecode_version{4};
+
+// First byte of every encoded node, the compiler dispatches on it to the single specialization of its node kind
+enum class Opcode : std::uint8_t {
+  EXPRESSION_LIST,
+  FUNCTION_CALL,
+  VARIABLE_DECLARATION,
+  VARIABLE_DECLARATION_WITH_INITIALIZER,
+  VARIABLE_DECLARATION_WITH_INITIALIZER_AUTO_TYPE,
+  VARIABLE,
+  ASSIGNMENT,
+  INT_LITERAL,
+  STRING_LITERAL,
+  FRAME,
+  DOUBLE_LITERAL,
+  HOST_VARIABLE,
+  MOVED_VARIABLE,
+  WHILE,
+  FOR,
+  IF,
+  BOOL_LITERAL,
+  FUNCTION,
+  TAIL_CALL,
+};
+
 #endif // AMSL_BYTES_HPP
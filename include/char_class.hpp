@@ -0,0 +1,82 @@
+#ifndef AMSL_CHAR_CLASS_HPP
+#define AMSL_CHAR_CLASS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include "token.hpp"
+
+enum class CharClass : std::uint8_t {
+  OTHER,
+  WHITESPACE,
+  DIGIT,
+  LETTER,
+  UNDERSCORE,
+  QUOTE,
+  BACKSLASH,
+  PUNCTUATION
+};
+
+inline constexpr std::uint8_t not_a_digit = 0xFF;
+
+struct CharInfo {
+  CharClass char_class{CharClass::OTHER};
+  // Value of the character as a digit of a base up to 16
+  std::uint8_t digit{not_a_digit};
+  // Single-character token kind of a punctuation character
+  TokenKind punctuation{};
+  // Second character (if any) of the two-character operator starting with this character and its token kind
+  char compound_follower{};
+  TokenKind compound{};
+};
+
+inline constexpr std::array<CharInfo, 256> char_table = []() {
+  std::array<CharInfo, 256> table{};
+  auto at = [&table](char chr) -> CharInfo & { return table[static_cast<unsigned char>(chr)]; };
+
+  for (char chr: std::string_view{" \n\r\f\v\t"})
+    at(chr).char_class = CharClass::WHITESPACE;
+  for (char chr = '0'; chr <= '9'; ++chr)
+    at(chr) = {CharClass::DIGIT, static_cast<std::uint8_t>(chr - '0')};
+  for (char chr = 'a'; chr <= 'z'; ++chr) {
+    at(chr).char_class = CharClass::LETTER;
+    at(static_cast<char>(chr - 'a' + 'A')).char_class = CharClass::LETTER;
+  }
+  for (char chr = 'a'; chr <= 'f'; ++chr) {
+    at(chr).digit = static_cast<std::uint8_t>(chr - 'a' + 10);
+    at(static_cast<char>(chr - 'a' + 'A')).digit = static_cast<std::uint8_t>(chr - 'a' + 10);
+  }
+  at('_').char_class = CharClass::UNDERSCORE;
+  at('\"').char_class = CharClass::QUOTE;
+  at('\\').char_class = CharClass::BACKSLASH;
+
+  constexpr std::pair<char, TokenKind> punctuation[]{
+    {';', TokenKind::SEMICOLON}, {':', TokenKind::COLON}, {',', TokenKind::COMMA}, {'.', TokenKind::DOT},
+    {'-', TokenKind::MINUS}, {'+', TokenKind::PLUS}, {'*', TokenKind::STAR}, {'/', TokenKind::SLASH},
+    {'(', TokenKind::LEFT_PAREN}, {')', TokenKind::RIGHT_PAREN}, {'[', TokenKind::LEFT_BRACKET},
+    {']', TokenKind::RIGHT_BRACKET}, {'{', TokenKind::LEFT_BRACE}, {'}', TokenKind::RIGHT_BRACE},
+    {'<', TokenKind::LESS}, {'>', TokenKind::GREATER}, {'@', TokenKind::AT}, {'&', TokenKind::AMPERSAND},
+    {'|', TokenKind::PIPE}, {'=', TokenKind::EQUAL}, {'!', TokenKind::EXCLAMATION}};
+  for (const auto &[chr, kind]: punctuation) {
+    at(chr).char_class = CharClass::PUNCTUATION;
+    at(chr).punctuation = kind;
+  }
+
+  constexpr std::tuple<char, char, TokenKind> compounds[]{
+    {'-', '>', TokenKind::ARROW},
+    {'.', '.', TokenKind::RANGE}};
+  for (const auto &[first, second, kind]: compounds) {
+    at(first).compound_follower = second;
+    at(first).compound = kind;
+  }
+
+  return table;
+}();
+
+constexpr const CharInfo &char_info(char chr) {
+  return char_table[static_cast<unsigned char>(chr)];
+}
+
+#endif // AMSL_CHAR_CLASS_HPP
@@ -1,10 +1,18 @@
 #ifndef AMSL_COMPILER_HPP
 #define AMSL_COMPILER_HPP
 
+#include "bytes.hpp"
+#include "simd.hpp"
 #include "string.hpp"
 #include "traits.hpp"
+#include <cstddef>
+#include <algorithm>
+#include <array>
 #include <bit>
-#include <span>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
 
 template<typename ExpressionPack>
 struct CompiledExpressionList {
@@ -17,19 +25,22 @@ struct CompiledFunctionCallExpression {
   using parameters = ParameterPack;
 };
 
-template<typename Type>
+template<std::size_t RefID, typename Type>
 struct CompiledVariableDeclarationExpression {
+  static constexpr auto ref_id = RefID;
   using type = Type;
 };
 
-template<typename Type, typename Initializer>
+template<std::size_t RefID, typename Type, typename Initializer>
 struct CompiledVariableDeclarationWithInitializerExpression {
+  static constexpr auto ref_id = RefID;
   using type = Type;
   using initializer = Initializer;
 };
 
-template<typename Initializer>
+template<std::size_t RefID, typename Initializer>
 struct CompiledVariableDeclarationWithInitializerAutoTypeExpression {
+  static constexpr auto ref_id = RefID;
   using initializer = Initializer;
 };
 
@@ -44,6 +55,59 @@ struct CompiledAssignmentExpression {
   using rhs = Rhs;
 };
 
+template<string_t Name>
+struct CompiledHostVariableExpression {
+  static constexpr auto name = Name;
+};
+
+template<std::size_t RefID>
+struct CompiledMovedVariableExpression {
+  static constexpr auto ref_id = RefID;
+};
+
+template<typename Condition, typename Body>
+struct CompiledWhileExpression {
+  using condition = Condition;
+  using body = Body;
+};
+
+template<std::size_t RefID, typename Begin, typename End, typename Body>
+struct CompiledForExpression {
+  static constexpr auto ref_id = RefID;
+  using begin = Begin;
+  using end = End;
+  using body = Body;
+};
+
+template<typename Condition, typename Then, typename Else>
+struct CompiledIfExpression {
+  using condition = Condition;
+  using then_branch = Then;
+  using else_branch = Else;
+};
+
+// `Parameters` are variable declarations, the first `Size` ref_ids are the function's own frame
+template<string_t Name, typename ReturnType, typename Parameters, std::size_t Size, typename Body>
+struct CompiledFunctionExpression {
+  static constexpr auto name = Name;
+  using return_type = ReturnType;
+  using parameters = Parameters;
+  static constexpr auto size = Size;
+  using body = Body;
+};
+
+// Jump back to the start of the enclosing function, `Arguments` replace its parameters
+template<typename Arguments>
+struct CompiledTailCallExpression {
+  using arguments = Arguments;
+};
+
+template<std::size_t Size, typename Body>
+struct CompiledFrame {
+  static constexpr auto size = Size;
+  using body = Body;
+};
+
 template<typename T, T Value>
 struct CompiledLiteral {
   using type = T;
@@ -53,38 +117,105 @@ struct CompiledLiteral {
 template<auto Value>
 using CompiledLiteralAuto = CompiledLiteral<std::remove_const_t<decltype(Value)>, Value>;
 
-template<auto Size>
-constexpr auto span_to_array(const auto &span) {
-  std::array<std::byte, Size> result;
-  std::copy(span.begin(), span.end(), result.begin());
-  return result;
+struct DecodedVarint {
+  std::size_t value{};
+  std::size_t size{};
+};
+
+// Reads the LEB128 varint written by Encoder<std::size_t>
+constexpr DecodedVarint decode_varint(auto it) {
+  DecodedVarint decoded{};
+  for (std::size_t shift = 0;; shift += 7) {
+    auto byte = std::to_integer<std::size_t>(*std::next(it, decoded.size++));
+    decoded.value |= (byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return decoded;
+  }
+}
+
+template<std::size_t N>
+consteval string_t<N + 1> decode_characters(auto it) {
+  string_t<N + 1> str{};
+  for (std::size_t idx = 0; idx < N; ++idx)
+    str.data[idx] = std::to_integer<char>(*std::next(it, idx));
+  return str;
 }
 
-template<auto Ptr, std::size_t Offset, Trivial T>
-struct TrivialDecoder {
-  static constexpr auto size = sizeof(T);
-  static constexpr auto next_offset = Offset + size;
-  static constexpr auto value = std::bit_cast<T>(
-    span_to_array<size>(std::span<const std::byte, size>{std::next(Ptr, Offset), size}));
+template<auto Ptr, std::size_t Offset>
+struct SizeDecoder {
+  static constexpr auto decoded = decode_varint(std::next(Ptr, Offset));
+  static constexpr auto next_offset = Offset + decoded.size;
+  static constexpr auto value = decoded.value;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct IntDecoder {
+  static constexpr auto decoded = decode_varint(std::next(Ptr, Offset));
+  static constexpr auto next_offset = Offset + decoded.size;
+  static constexpr auto value = static_cast<int>(static_cast<std::uint32_t>(decoded.value >> 1) ^
+                                                 -static_cast<std::uint32_t>(decoded.value & 1));
 };
 
+// Doubles are encoded as their object representation
 template<auto Ptr, std::size_t Offset>
-using IntDecoder = TrivialDecoder<Ptr, Offset, int>;
+struct DoubleDecoder {
+  static constexpr auto next_offset = Offset + sizeof(double);
+  static constexpr auto value = std::bit_cast<double>([]() {
+    std::array<std::byte, sizeof(double)> bytes{};
+    std::copy_n(std::next(Ptr, Offset), bytes.size(), bytes.begin());
+    return bytes;
+  }());
+};
 
 template<auto Ptr, std::size_t Offset>
-using SizeDecoder = TrivialDecoder<Ptr, Offset, std::size_t>;
+struct BoolDecoder {
+  static constexpr auto next_offset = Offset + 1;
+  static constexpr bool value = std::to_integer<bool>(*std::next(Ptr, Offset));
+};
 
 template<auto Ptr, std::size_t Offset>
 struct StringDecoder {
   using size_decoder = SizeDecoder<Ptr, Offset>;
-  using data_decoder = TrivialDecoder<Ptr, size_decoder::next_offset, string_t<size_decoder::value>>;
-  static constexpr auto next_offset = data_decoder::next_offset;
-  static constexpr auto value = data_decoder::value;
+  static constexpr auto next_offset = size_decoder::next_offset + size_decoder::value;
+  static constexpr auto value = decode_characters<size_decoder::value>(std::next(Ptr, size_decoder::next_offset));
+};
+
+// Locates every string of the pool that follows the version byte, so that strings are decoded by their index
+template<auto Ptr>
+struct StringPoolDecoder {
+  using size_decoder = SizeDecoder<Ptr, 1>;
+  static constexpr auto size = size_decoder::value;
+
+  static constexpr auto offsets = []() {
+    std::array<std::size_t, size + 1> offsets{size_decoder::next_offset};
+    for (std::size_t idx = 0; idx < size; ++idx) {
+      auto length = decode_varint(std::next(Ptr, offsets[idx]));
+      offsets[idx + 1] = offsets[idx] + length.size + length.value;
+    }
+    return offsets;
+  }();
+  static constexpr auto next_offset = offsets[size];
+};
+
+// Every occurrence of a pooled string shares the StringDecoder of its pool entry
+template<auto Ptr, std::size_t Offset>
+struct PooledStringDecoder {
+  using index_decoder = SizeDecoder<Ptr, Offset>;
+  static constexpr auto next_offset = index_decoder::next_offset;
+  static constexpr auto value = StringDecoder<Ptr, StringPoolDecoder<Ptr>::offsets[index_decoder::value]>::value;
 };
 
 template<string_t Str>
 struct TypeDecoder;
 
+// Type that is omitted (of a function parameter or a return type), it is taken from the value at every call
+struct InferredType {};
+
+template<>
+struct TypeDecoder<""> {
+  using type = InferredType;
+};
+
 template<>
 struct TypeDecoder<"int"> {
   using type = int;
@@ -156,10 +287,43 @@ struct TypeDecoder<"size"> {
   using type = std::size_t;
 };
 
-template<auto Ptr, std::size_t Offset = 0>
-struct Compiler {
+// Element type name of an `array<T>` type name, empty if the name is not one
+constexpr std::string_view array_element_type_name(std::string_view name) {
+  constexpr std::string_view prefix{"array<"};
+  if (!name.starts_with(prefix) || !name.ends_with('>'))
+    return {};
+  auto element = name.substr(prefix.size(), name.size() - prefix.size() - 1);
+  while (!element.empty() && element.front() == ' ')
+    element.remove_prefix(1);
+  while (!element.empty() && element.back() == ' ')
+    element.remove_suffix(1);
+  return element;
+}
+
+// `array<T>`: contiguous elements of type T
+template<string_t Str> requires (!array_element_type_name(std::string_view{Str.data.data(), Str.Size}).empty())
+struct TypeDecoder<Str> {
+  static constexpr auto view = std::string_view{Str.data.data(), Str.Size};
+  static constexpr auto element = array_element_type_name(view);
+  static constexpr auto element_offset = static_cast<std::size_t>(element.data() - view.data());
+  using type = std::vector<typename TypeDecoder<Str.template substr<element_offset, element.size()>()>::type>;
 };
 
+// `vec<T, N>`: N lanes of the numeric type T, a GCC vector extension type
+template<string_t Str> requires (parse_simd_type_name(std::string_view{Str.data.data(), Str.Size}).valid)
+struct TypeDecoder<Str> {
+  static constexpr auto name = parse_simd_type_name(std::string_view{Str.data.data(), Str.Size});
+  using lane_type = typename TypeDecoder<Str.template substr<name.lane_type_offset, name.lane_type_size>()>::type;
+  static_assert(std::is_arithmetic_v<lane_type> && !std::is_same_v<lane_type, bool>,
+                "Vector lanes have to be of a numeric type");
+  static_assert(std::has_single_bit(name.lanes), "Vector lane count has to be a power of 2");
+  using type = typename SimdType<lane_type, name.lanes>::type;
+};
+
+// Dispatches on the opcode of the node at `Offset`, every opcode has exactly one specialization
+template<auto Ptr, std::size_t Offset, Opcode Op = static_cast<Opcode>(*std::next(Ptr, Offset))>
+struct Compiler;
+
 template<typename ... Args>
 class ParameterPack;
 
@@ -174,12 +338,169 @@ struct parameter_pack_join<ParameterPack<Args1...>, ParameterPack<Args2...>> {
 template<typename Pack1, typename Pack2>
 using parameter_pack_join_t = typename parameter_pack_join<Pack1, Pack2>::type;
 
+template<typename Pack>
+struct parameter_pack_tag {
+  using type = Pack;
+};
+
+template<typename... Args1, typename... Args2>
+parameter_pack_tag<ParameterPack<Args1..., Args2...>> operator+(parameter_pack_tag<ParameterPack<Args1...>>,
+                                                                parameter_pack_tag<ParameterPack<Args2...>>);
+
+// Joins any number of packs with a fold expression instead of recursion
+template<typename... Packs>
+using parameter_pack_concat_t = typename decltype((parameter_pack_tag<ParameterPack<>>{} + ... +
+                                                   parameter_pack_tag<Packs>{}))::type;
+
+template<std::size_t Idx, typename Pack>
+struct parameter_pack_element;
+
+template<std::size_t Idx, typename... Args>
+struct parameter_pack_element<Idx, ParameterPack<Args...>> {
+  using type = pack_element_t<Idx, Args...>;
+};
+
+template<std::size_t Idx, typename Pack>
+using parameter_pack_element_t = typename parameter_pack_element<Idx, Pack>::type;
+
+// Collects variable declarations of a TB-AST in ref_id order (initializer's declarations precede the declaration itself)
+template<typename Expression>
+struct CompiledDeclarations {
+  using type = ParameterPack<>;
+};
+
+template<typename... Expressions>
+struct CompiledDeclarations<CompiledExpressionList<ParameterPack<Expressions...>>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Expressions>::type...>;
+};
+
+template<string_t Name, typename... Parameters>
+struct CompiledDeclarations<CompiledFunctionCallExpression<Name, ParameterPack<Parameters...>>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Parameters>::type...>;
+};
+
+template<std::size_t RefID, typename Type>
+struct CompiledDeclarations<CompiledVariableDeclarationExpression<RefID, Type>> {
+  using type = ParameterPack<CompiledVariableDeclarationExpression<RefID, Type>>;
+};
+
+template<std::size_t RefID, typename Type, typename Initializer>
+struct CompiledDeclarations<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Initializer>::type,
+    ParameterPack<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>>>;
+};
+
+template<std::size_t RefID, typename Initializer>
+struct CompiledDeclarations<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Initializer>::type,
+    ParameterPack<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>>>;
+};
+
+template<typename Lhs, typename Rhs>
+struct CompiledDeclarations<CompiledAssignmentExpression<Lhs, Rhs>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Lhs>::type,
+    typename CompiledDeclarations<Rhs>::type>;
+};
+
+template<typename Condition, typename Body>
+struct CompiledDeclarations<CompiledWhileExpression<Condition, Body>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Condition>::type,
+    typename CompiledDeclarations<Body>::type>;
+};
+
+// The loop itself declares its variable, after the bounds and before the body
+template<std::size_t RefID, typename Begin, typename End, typename Body>
+struct CompiledDeclarations<CompiledForExpression<RefID, Begin, End, Body>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Begin>::type,
+    typename CompiledDeclarations<End>::type, ParameterPack<CompiledForExpression<RefID, Begin, End, Body>>,
+    typename CompiledDeclarations<Body>::type>;
+};
+
+template<typename Condition, typename Then, typename Else>
+struct CompiledDeclarations<CompiledIfExpression<Condition, Then, Else>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Condition>::type,
+    typename CompiledDeclarations<Then>::type, typename CompiledDeclarations<Else>::type>;
+};
+
+template<typename... Arguments>
+struct CompiledDeclarations<CompiledTailCallExpression<ParameterPack<Arguments...>>> {
+  using type = parameter_pack_concat_t<typename CompiledDeclarations<Arguments>::type...>;
+};
+
+// Collects the function definitions of a TB-AST, the ones nested in functions included
+template<typename Expression>
+struct CompiledFunctions {
+  using type = ParameterPack<>;
+};
+
+template<typename... Expressions>
+struct CompiledFunctions<CompiledExpressionList<ParameterPack<Expressions...>>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Expressions>::type...>;
+};
+
+template<string_t Name, typename... Parameters>
+struct CompiledFunctions<CompiledFunctionCallExpression<Name, ParameterPack<Parameters...>>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Parameters>::type...>;
+};
+
+template<std::size_t RefID, typename Type, typename Initializer>
+struct CompiledFunctions<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>> {
+  using type = typename CompiledFunctions<Initializer>::type;
+};
+
+template<std::size_t RefID, typename Initializer>
+struct CompiledFunctions<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>> {
+  using type = typename CompiledFunctions<Initializer>::type;
+};
+
+template<typename Lhs, typename Rhs>
+struct CompiledFunctions<CompiledAssignmentExpression<Lhs, Rhs>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Lhs>::type, typename CompiledFunctions<Rhs>::type>;
+};
+
+template<typename Condition, typename Body>
+struct CompiledFunctions<CompiledWhileExpression<Condition, Body>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Condition>::type,
+    typename CompiledFunctions<Body>::type>;
+};
+
+template<std::size_t RefID, typename Begin, typename End, typename Body>
+struct CompiledFunctions<CompiledForExpression<RefID, Begin, End, Body>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Begin>::type, typename CompiledFunctions<End>::type,
+    typename CompiledFunctions<Body>::type>;
+};
+
+template<typename Condition, typename Then, typename Else>
+struct CompiledFunctions<CompiledIfExpression<Condition, Then, Else>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Condition>::type,
+    typename CompiledFunctions<Then>::type, typename CompiledFunctions<Else>::type>;
+};
+
+template<typename... Arguments>
+struct CompiledFunctions<CompiledTailCallExpression<ParameterPack<Arguments...>>> {
+  using type = parameter_pack_concat_t<typename CompiledFunctions<Arguments>::type...>;
+};
+
+template<string_t Name, typename ReturnType, typename Parameters, std::size_t Size, typename Body>
+struct CompiledFunctions<CompiledFunctionExpression<Name, ReturnType, Parameters, Size, Body>> {
+  using type = parameter_pack_concat_t<ParameterPack<CompiledFunctionExpression<Name, ReturnType, Parameters, Size,
+    Body>>, typename CompiledFunctions<Body>::type>;
+};
+
+// Splits the pack in halves, so a pack of N expressions needs O(log N) template depth and O(N log N) joined elements
 template<auto Ptr, std::size_t Offset, std::size_t Size>
 struct SizedParameterPackCompiler {
+  using left_compiler = SizedParameterPackCompiler<Ptr, Offset, Size / 2>;
+  using right_compiler = SizedParameterPackCompiler<Ptr, left_compiler::next_offset, Size - Size / 2>;
+  static constexpr auto next_offset = right_compiler::next_offset;
+  using compiled = parameter_pack_join_t<typename left_compiler::compiled, typename right_compiler::compiled>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct SizedParameterPackCompiler<Ptr, Offset, 1> {
   using this_compiler = Compiler<Ptr, Offset>;
-  using next_compiler = SizedParameterPackCompiler<Ptr, this_compiler::next_offset, Size - 1>;
-  static constexpr auto next_offset = next_compiler::next_offset;
-  using compiled = parameter_pack_join_t<ParameterPack<typename this_compiler::compiled>, typename next_compiler::compiled>;
+  static constexpr auto next_offset = this_compiler::next_offset;
+  using compiled = ParameterPack<typename this_compiler::compiled>;
 };
 
 template<auto Ptr, std::size_t Offset>
@@ -198,72 +519,167 @@ struct ParameterPackCompiler {
   using compiled = this_compiler::compiled;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{0})
-struct Compiler<Ptr, Offset> {
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::EXPRESSION_LIST> {
   using this_compiler = ParameterPackCompiler<Ptr, Offset + 1>;
   static constexpr auto next_offset = this_compiler::next_offset;
   using compiled = CompiledExpressionList<typename this_compiler::compiled>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{1})
-struct Compiler<Ptr, Offset> {
-  using name_decoder = StringDecoder<Ptr, Offset + 1>;
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::FUNCTION_CALL> {
+  using name_decoder = PooledStringDecoder<Ptr, Offset + 1>;
   using parameters_compiler = ParameterPackCompiler<Ptr, name_decoder::next_offset>;
   static constexpr auto next_offset = parameters_compiler::next_offset;
   using compiled = CompiledFunctionCallExpression<name_decoder::value, typename parameters_compiler::compiled>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{2})
-struct Compiler<Ptr, Offset> {
-  using type_string_decoder = StringDecoder<Ptr, Offset + 1>;
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::VARIABLE_DECLARATION> {
+  using type_string_decoder = PooledStringDecoder<Ptr, Offset + 1>;
+  using ref_id_decoder = SizeDecoder<Ptr, type_string_decoder::next_offset>;
   using type_decoder = TypeDecoder<type_string_decoder::value>;
-  static constexpr auto next_offset = type_string_decoder::next_offset;
-  using compiled = CompiledVariableDeclarationExpression<typename type_decoder::type>;
+  static constexpr auto next_offset = ref_id_decoder::next_offset;
+  using compiled = CompiledVariableDeclarationExpression<ref_id_decoder::value, typename type_decoder::type>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{3})
-struct Compiler<Ptr, Offset> {
-  using type_string_decoder = StringDecoder<Ptr, Offset + 1>;
-  using initializer_compiler = Compiler<Ptr, type_string_decoder::next_offset>;
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::VARIABLE_DECLARATION_WITH_INITIALIZER> {
+  using type_string_decoder = PooledStringDecoder<Ptr, Offset + 1>;
+  using ref_id_decoder = SizeDecoder<Ptr, type_string_decoder::next_offset>;
+  using initializer_compiler = Compiler<Ptr, ref_id_decoder::next_offset>;
   using type_decoder = TypeDecoder<type_string_decoder::value>;
   static constexpr auto next_offset = initializer_compiler::next_offset;
-  using compiled = CompiledVariableDeclarationWithInitializerExpression<typename type_decoder::type, typename initializer_compiler::compiled>;
+  using compiled = CompiledVariableDeclarationWithInitializerExpression<ref_id_decoder::value, typename type_decoder::type, typename initializer_compiler::compiled>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{4})
-struct Compiler<Ptr, Offset> {
-  using initializer_compiler = Compiler<Ptr, Offset + 1>;
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::VARIABLE_DECLARATION_WITH_INITIALIZER_AUTO_TYPE> {
+  using ref_id_decoder = SizeDecoder<Ptr, Offset + 1>;
+  using initializer_compiler = Compiler<Ptr, ref_id_decoder::next_offset>;
   static constexpr auto next_offset = initializer_compiler::next_offset;
-  using compiled = CompiledVariableDeclarationWithInitializerAutoTypeExpression<typename initializer_compiler::compiled>;
+  using compiled = CompiledVariableDeclarationWithInitializerAutoTypeExpression<ref_id_decoder::value, typename initializer_compiler::compiled>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{5})
-struct Compiler<Ptr, Offset> {
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::VARIABLE> {
   using this_decoder = SizeDecoder<Ptr, Offset + 1>;
   static constexpr auto next_offset = this_decoder::next_offset;
   using compiled = CompiledVariableExpression<this_decoder::value>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{6})
-struct Compiler<Ptr, Offset> {
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::ASSIGNMENT> {
   using left_compiler = Compiler<Ptr, Offset + 1>;
   using right_compiler = Compiler<Ptr, left_compiler::next_offset>;
   static constexpr auto next_offset = right_compiler::next_offset;
   using compiled = CompiledAssignmentExpression<typename left_compiler::compiled, typename right_compiler::compiled>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{7})
-struct Compiler<Ptr, Offset> {
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::INT_LITERAL> {
   using this_decoder = IntDecoder<Ptr, Offset + 1>;
   static constexpr auto next_offset = this_decoder::next_offset;
   using compiled = CompiledLiteralAuto<this_decoder::value>;
 };
 
-template<auto Ptr, std::size_t Offset> requires (*std::next(Ptr, Offset) == std::byte{8})
-struct Compiler<Ptr, Offset> {
-  using this_decoder = StringDecoder<Ptr, Offset + 1>;
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::STRING_LITERAL> {
+  using this_decoder = PooledStringDecoder<Ptr, Offset + 1>;
+  static constexpr auto next_offset = this_decoder::next_offset;
+  using compiled = CompiledLiteralAuto<this_decoder::value>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::FRAME> {
+  using size_decoder = SizeDecoder<Ptr, Offset + 1>;
+  using body_compiler = Compiler<Ptr, size_decoder::next_offset>;
+  static constexpr auto next_offset = body_compiler::next_offset;
+  using compiled = CompiledFrame<size_decoder::value, typename body_compiler::compiled>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::DOUBLE_LITERAL> {
+  using this_decoder = DoubleDecoder<Ptr, Offset + 1>;
   static constexpr auto next_offset = this_decoder::next_offset;
   using compiled = CompiledLiteralAuto<this_decoder::value>;
 };
 
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::HOST_VARIABLE> {
+  using name_decoder = PooledStringDecoder<Ptr, Offset + 1>;
+  static constexpr auto next_offset = name_decoder::next_offset;
+  using compiled = CompiledHostVariableExpression<name_decoder::value>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::MOVED_VARIABLE> {
+  using this_decoder = SizeDecoder<Ptr, Offset + 1>;
+  static constexpr auto next_offset = this_decoder::next_offset;
+  using compiled = CompiledMovedVariableExpression<this_decoder::value>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::WHILE> {
+  using condition_compiler = Compiler<Ptr, Offset + 1>;
+  using body_compiler = Compiler<Ptr, condition_compiler::next_offset>;
+  static constexpr auto next_offset = body_compiler::next_offset;
+  using compiled = CompiledWhileExpression<typename condition_compiler::compiled, typename body_compiler::compiled>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::FOR> {
+  using ref_id_decoder = SizeDecoder<Ptr, Offset + 1>;
+  using begin_compiler = Compiler<Ptr, ref_id_decoder::next_offset>;
+  using end_compiler = Compiler<Ptr, begin_compiler::next_offset>;
+  using body_compiler = Compiler<Ptr, end_compiler::next_offset>;
+  static constexpr auto next_offset = body_compiler::next_offset;
+  using compiled = CompiledForExpression<ref_id_decoder::value, typename begin_compiler::compiled,
+    typename end_compiler::compiled, typename body_compiler::compiled>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::IF> {
+  using condition_compiler = Compiler<Ptr, Offset + 1>;
+  using then_compiler = Compiler<Ptr, condition_compiler::next_offset>;
+  using else_compiler = Compiler<Ptr, then_compiler::next_offset>;
+  static constexpr auto next_offset = else_compiler::next_offset;
+  using compiled = CompiledIfExpression<typename condition_compiler::compiled, typename then_compiler::compiled,
+    typename else_compiler::compiled>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::BOOL_LITERAL> {
+  using this_decoder = BoolDecoder<Ptr, Offset + 1>;
+  static constexpr auto next_offset = this_decoder::next_offset;
+  using compiled = CompiledLiteralAuto<this_decoder::value>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::FUNCTION> {
+  using name_decoder = PooledStringDecoder<Ptr, Offset + 1>;
+  using return_type_string_decoder = PooledStringDecoder<Ptr, name_decoder::next_offset>;
+  using parameters_compiler = ParameterPackCompiler<Ptr, return_type_string_decoder::next_offset>;
+  using size_decoder = SizeDecoder<Ptr, parameters_compiler::next_offset>;
+  using body_compiler = Compiler<Ptr, size_decoder::next_offset>;
+  using return_type_decoder = TypeDecoder<return_type_string_decoder::value>;
+  static constexpr auto next_offset = body_compiler::next_offset;
+  using compiled = CompiledFunctionExpression<name_decoder::value, typename return_type_decoder::type,
+    typename parameters_compiler::compiled, size_decoder::value, typename body_compiler::compiled>;
+};
+
+template<auto Ptr, std::size_t Offset>
+struct Compiler<Ptr, Offset, Opcode::TAIL_CALL> {
+  using arguments_compiler = ParameterPackCompiler<Ptr, Offset + 1>;
+  static constexpr auto next_offset = arguments_compiler::next_offset;
+  using compiled = CompiledTailCallExpression<typename arguments_compiler::compiled>;
+};
+
+// Compiles an encoded program, rejecting byte arrays encoded with another version of the format
+template<auto Ptr>
+struct ProgramCompiler {
+  static_assert(*Ptr == bytecode_version, "Program was encoded with an incompatible byte format version");
+  using compiled = Compiler<Ptr, StringPoolDecoder<Ptr>::next_offset>::compiled;
+};
+
 #endif // AMSL_COMPILER_HPP
@@ -1,9 +1,17 @@
 #ifndef AMSL_ENCODER_HPP
 #define AMSL_ENCODER_HPP
 
+#include <bit>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "bytes.hpp"
+#include "symbol_table.hpp"
 #include "traits.hpp"
-#include "ptr_wrapper.hpp"
+#include "utils.hpp"
 
 template<typename T>
 struct Encoder;
@@ -21,10 +29,22 @@ struct Encoder<T> {
   }
 };
 
-template<typename T>
-struct Encoder<ptr_wrapper<T>> {
-  static constexpr void encode(Bytes &bytes, const ptr_wrapper<T> &value) {
-    ::encode(bytes, value.get());
+// Unsigned LEB128: seven bits per byte starting from the least significant ones, the high bit marks that more follow
+template<>
+struct Encoder<std::size_t> {
+  static constexpr void encode(Bytes &bytes, std::size_t value) {
+    for (; value >= 0x80; value >>= 7)
+      bytes.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+    bytes.push_back(static_cast<std::byte>(value));
+  }
+};
+
+// Zigzag mapped (0, -1, 1, -2, ... to 0, 1, 2, 3, ...) before LEB128, so that small negative values stay short
+template<>
+struct Encoder<int> {
+  static constexpr void encode(Bytes &bytes, int value) {
+    auto zigzag = static_cast<std::uint32_t>(value) << 1 ^ static_cast<std::uint32_t>(value >> 31);
+    ::encode(bytes, static_cast<std::size_t>(zigzag));
   }
 };
 
@@ -38,16 +58,6 @@ struct Encoder<std::optional<T>> {
   }
 };
 
-template<typename T>
-struct Encoder<T *> {
-  static constexpr void encode(Bytes &bytes, const T *value) {
-    if constexpr (std::is_base_of_v<Encodable, T>)
-      value->encode(bytes);
-    else
-      ::encode(bytes, *value);
-  }
-};
-
 template<Vector T>
 struct Encoder<T> {
   static constexpr void encode(Bytes &bytes, const T &value) {
@@ -58,12 +68,58 @@ struct Encoder<T> {
 };
 
 template<>
-struct Encoder<std::string> {
-  static constexpr void encode(Bytes &bytes, const std::string &value) {
-    ::encode(bytes, value.size() + 1);
+struct Encoder<std::string_view> {
+  static constexpr void encode(Bytes &bytes, std::string_view value) {
+    ::encode(bytes, value.size());
     for (const auto &item: value)
       ::encode(bytes, item);
-    ::encode(bytes, std::byte{0});
+  }
+};
+
+template<>
+struct Encoder<std::string> {
+  static constexpr void encode(Bytes &bytes, const std::string &value) {
+    ::encode(bytes, std::string_view{value});
+  }
+};
+
+// Encoded exactly as the unescaped std::string would be, without materializing it
+template<>
+struct Encoder<EscapedString> {
+  static constexpr void encode(Bytes &bytes, const EscapedString &value) {
+    ::encode(bytes, unescaped_size(value.text));
+    unescape(value.text, [&bytes](char chr) { ::encode(bytes, chr); });
+  }
+};
+
+// Deduplicated strings of an encoded program, nodes refer to them by their index in the pool. Strings are interned
+// by their text in the source code (names have nothing to unescape), so equal texts are always equal strings
+class StringPool {
+public:
+  constexpr std::size_t intern(const EscapedString &str) {
+    auto index = indices.intern(str.text);
+    if (index == strings.size())
+      strings.push_back(str);
+    return index;
+  }
+
+  constexpr std::size_t intern(std::string_view str) {
+    return intern(EscapedString{str});
+  }
+
+  [[nodiscard]] constexpr const std::vector<EscapedString> &values() const {
+    return strings;
+  }
+
+private:
+  std::vector<EscapedString> strings{};
+  IdentifierTable indices{};
+};
+
+template<>
+struct Encoder<StringPool> {
+  static constexpr void encode(Bytes &bytes, const StringPool &pool) {
+    ::encode(bytes, pool.values());
   }
 };
 
@@ -1,107 +1,738 @@
 #ifndef AMSL_EXECUTOR_HPP
 #define AMSL_EXECUTOR_HPP
 
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "compiler.hpp"
 #include "amsl.hpp"
 #include "builtin_functions.hpp"
+#include "format.hpp"
+#include "frame.hpp"
+#include "host_functions.hpp"
+#include "host_variables.hpp"
+#include "output.hpp"
 #include "utils.hpp"
 
+// Loops over literal bounds running at most this many iterations are fully unrolled, 0 disables unrolling
+#ifndef AMSL_MAX_UNROLLED_ITERATIONS
+#define AMSL_MAX_UNROLLED_ITERATIONS 16
+#endif
+
 template<typename T>
 struct Executor;
 
-template<typename Expression, typename... Expressions>
-struct Executor<CompiledExpressionList<ParameterPack<Expression, Expressions...>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    Executor<Expression>{}(std::forward<LocalScopeArgs>(args)...);
-    return Executor<CompiledExpressionList<ParameterPack<Expressions...>>>{}(std::forward<LocalScopeArgs>(args)...);
+template<typename Declarations, typename Bindings>
+struct InferenceFrame;
+
+template<string_t Name>
+concept OutputBuiltin = requires { BuiltinFunction<Name>::writes_output; };
+
+// Whether a TB-AST calls builtin functions writing to the output sink
+template<typename Expression>
+struct WritesOutput : std::false_type {};
+
+template<typename... Expressions>
+struct WritesOutput<CompiledExpressionList<ParameterPack<Expressions...>>>
+  : std::disjunction<WritesOutput<Expressions>...> {};
+
+template<string_t Name, typename... Parameters>
+struct WritesOutput<CompiledFunctionCallExpression<Name, ParameterPack<Parameters...>>>
+  : std::bool_constant<OutputBuiltin<Name> || (WritesOutput<Parameters>::value || ...)> {};
+
+template<std::size_t RefID, typename Type, typename Initializer>
+struct WritesOutput<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>>
+  : WritesOutput<Initializer> {};
+
+template<std::size_t RefID, typename Initializer>
+struct WritesOutput<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>>
+  : WritesOutput<Initializer> {};
+
+template<typename Lhs, typename Rhs>
+struct WritesOutput<CompiledAssignmentExpression<Lhs, Rhs>>
+  : std::disjunction<WritesOutput<Lhs>, WritesOutput<Rhs>> {};
+
+template<typename Condition, typename Body>
+struct WritesOutput<CompiledWhileExpression<Condition, Body>>
+  : std::disjunction<WritesOutput<Condition>, WritesOutput<Body>> {};
+
+template<std::size_t RefID, typename Begin, typename End, typename Body>
+struct WritesOutput<CompiledForExpression<RefID, Begin, End, Body>>
+  : std::disjunction<WritesOutput<Begin>, WritesOutput<End>, WritesOutput<Body>> {};
+
+template<typename Condition, typename Then, typename Else>
+struct WritesOutput<CompiledIfExpression<Condition, Then, Else>>
+  : std::disjunction<WritesOutput<Condition>, WritesOutput<Then>, WritesOutput<Else>> {};
+
+template<typename... Arguments>
+struct WritesOutput<CompiledTailCallExpression<ParameterPack<Arguments...>>>
+  : std::disjunction<WritesOutput<Arguments>...> {};
+
+// A function writes output wherever it is called
+template<string_t Name, typename ReturnType, typename Parameters, std::size_t Size, typename Body>
+struct WritesOutput<CompiledFunctionExpression<Name, ReturnType, Parameters, Size, Body>> : WritesOutput<Body> {};
+
+template<typename Expression>
+struct IsHostVariable : std::false_type {};
+
+template<string_t Name>
+struct IsHostVariable<CompiledHostVariableExpression<Name>> : std::true_type {};
+
+// Whether a TB-AST may touch state that concurrent calls of a function share: calling builtin functions doing I/O
+// (writing output among them), calling host or script functions, or writing host variables by assigning to them or
+// passing them to a function that may write its arguments
+template<typename Expression>
+struct SharesState : std::false_type {};
+
+template<typename... Expressions>
+struct SharesState<CompiledExpressionList<ParameterPack<Expressions...>>>
+  : std::disjunction<SharesState<Expressions>...> {};
+
+template<string_t Name, typename... Parameters>
+struct SharesState<CompiledFunctionCallExpression<Name, ParameterPack<Parameters...>>>
+  : std::bool_constant<builtin_effect(std::string_view{Name.data.data(), Name.Size}) == Effect::IO ||
+                       (may_write_arguments(std::string_view{Name.data.data(), Name.Size}) &&
+                        (IsHostVariable<Parameters>::value || ...)) || (SharesState<Parameters>::value || ...)> {};
+
+template<std::size_t RefID, typename Type, typename Initializer>
+struct SharesState<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>>
+  : SharesState<Initializer> {};
+
+template<std::size_t RefID, typename Initializer>
+struct SharesState<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>>
+  : SharesState<Initializer> {};
+
+template<typename Lhs, typename Rhs>
+struct SharesState<CompiledAssignmentExpression<Lhs, Rhs>>
+  : std::disjunction<IsHostVariable<Lhs>, SharesState<Lhs>, SharesState<Rhs>> {};
+
+template<typename Condition, typename Body>
+struct SharesState<CompiledWhileExpression<Condition, Body>>
+  : std::disjunction<SharesState<Condition>, SharesState<Body>> {};
+
+template<std::size_t RefID, typename Begin, typename End, typename Body>
+struct SharesState<CompiledForExpression<RefID, Begin, End, Body>>
+  : std::disjunction<SharesState<Begin>, SharesState<End>, SharesState<Body>> {};
+
+template<typename Condition, typename Then, typename Else>
+struct SharesState<CompiledIfExpression<Condition, Then, Else>>
+  : std::disjunction<SharesState<Condition>, SharesState<Then>, SharesState<Else>> {};
+
+template<typename... Arguments>
+struct SharesState<CompiledTailCallExpression<ParameterPack<Arguments...>>>
+  : std::disjunction<SharesState<Arguments>...> {};
+
+template<string_t Name, typename ReturnType, typename Parameters, std::size_t Size, typename Body>
+struct SharesState<CompiledFunctionExpression<Name, ReturnType, Parameters, Size, Body>> : SharesState<Body> {};
+
+// Whether a TB-AST may write the local `RefID`, by assigning to it or passing it to a function that may write its
+// arguments
+template<typename Expression, std::size_t RefID>
+struct WritesVariable : std::false_type {};
+
+template<typename... Expressions, std::size_t RefID>
+struct WritesVariable<CompiledExpressionList<ParameterPack<Expressions...>>, RefID>
+  : std::disjunction<WritesVariable<Expressions, RefID>...> {};
+
+template<string_t Name, typename... Parameters, std::size_t RefID>
+struct WritesVariable<CompiledFunctionCallExpression<Name, ParameterPack<Parameters...>>, RefID>
+  : std::bool_constant<(may_write_arguments(std::string_view{Name.data.data(), Name.Size}) &&
+                        (std::same_as<Parameters, CompiledVariableExpression<RefID>> || ...)) ||
+                       (WritesVariable<Parameters, RefID>::value || ...)> {};
+
+template<std::size_t DeclaredID, typename Type, typename Initializer, std::size_t RefID>
+struct WritesVariable<CompiledVariableDeclarationWithInitializerExpression<DeclaredID, Type, Initializer>, RefID>
+  : WritesVariable<Initializer, RefID> {};
+
+template<std::size_t DeclaredID, typename Initializer, std::size_t RefID>
+struct WritesVariable<CompiledVariableDeclarationWithInitializerAutoTypeExpression<DeclaredID, Initializer>, RefID>
+  : WritesVariable<Initializer, RefID> {};
+
+template<typename Lhs, typename Rhs, std::size_t RefID>
+struct WritesVariable<CompiledAssignmentExpression<Lhs, Rhs>, RefID>
+  : std::bool_constant<std::same_as<Lhs, CompiledVariableExpression<RefID>> || WritesVariable<Lhs, RefID>::value ||
+                       WritesVariable<Rhs, RefID>::value> {};
+
+template<typename Condition, typename Body, std::size_t RefID>
+struct WritesVariable<CompiledWhileExpression<Condition, Body>, RefID>
+  : std::disjunction<WritesVariable<Condition, RefID>, WritesVariable<Body, RefID>> {};
+
+template<std::size_t LoopID, typename Begin, typename End, typename Body, std::size_t RefID>
+struct WritesVariable<CompiledForExpression<LoopID, Begin, End, Body>, RefID>
+  : std::disjunction<WritesVariable<Begin, RefID>, WritesVariable<End, RefID>, WritesVariable<Body, RefID>> {};
+
+template<typename Condition, typename Then, typename Else, std::size_t RefID>
+struct WritesVariable<CompiledIfExpression<Condition, Then, Else>, RefID>
+  : std::disjunction<WritesVariable<Condition, RefID>, WritesVariable<Then, RefID>, WritesVariable<Else, RefID>> {};
+
+template<typename... Arguments, std::size_t RefID>
+struct WritesVariable<CompiledTailCallExpression<ParameterPack<Arguments...>>, RefID>
+  : std::bool_constant<(RefID < sizeof...(Arguments)) || (WritesVariable<Arguments, RefID>::value || ...)> {};
+
+// Whether a function body jumps back to its start, tail calls are only made in tail position
+template<typename Expression>
+struct MakesTailCall : std::false_type {};
+
+template<typename... Expressions>
+struct MakesTailCall<CompiledExpressionList<ParameterPack<Expressions...>>>
+  : std::disjunction<MakesTailCall<Expressions>...> {};
+
+template<typename Condition, typename Then, typename Else>
+struct MakesTailCall<CompiledIfExpression<Condition, Then, Else>>
+  : std::disjunction<MakesTailCall<Then>, MakesTailCall<Else>> {};
+
+template<typename Arguments>
+struct MakesTailCall<CompiledTailCallExpression<Arguments>> : std::true_type {};
+
+// Whether a TB-AST calls the function `Name`, the bodies of functions defined in it are not looked into
+template<typename Expression, string_t Name>
+struct CallsFunction : std::false_type {};
+
+template<typename... Expressions, string_t Name>
+struct CallsFunction<CompiledExpressionList<ParameterPack<Expressions...>>, Name>
+  : std::disjunction<CallsFunction<Expressions, Name>...> {};
+
+template<string_t Callee, typename... Parameters, string_t Name>
+struct CallsFunction<CompiledFunctionCallExpression<Callee, ParameterPack<Parameters...>>, Name>
+  : std::bool_constant<Callee == Name || (CallsFunction<Parameters, Name>::value || ...)> {};
+
+template<std::size_t RefID, typename Type, typename Initializer, string_t Name>
+struct CallsFunction<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>, Name>
+  : CallsFunction<Initializer, Name> {};
+
+template<std::size_t RefID, typename Initializer, string_t Name>
+struct CallsFunction<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>, Name>
+  : CallsFunction<Initializer, Name> {};
+
+template<typename Lhs, typename Rhs, string_t Name>
+struct CallsFunction<CompiledAssignmentExpression<Lhs, Rhs>, Name>
+  : std::disjunction<CallsFunction<Lhs, Name>, CallsFunction<Rhs, Name>> {};
+
+template<typename Condition, typename Body, string_t Name>
+struct CallsFunction<CompiledWhileExpression<Condition, Body>, Name>
+  : std::disjunction<CallsFunction<Condition, Name>, CallsFunction<Body, Name>> {};
+
+template<std::size_t RefID, typename Begin, typename End, typename Body, string_t Name>
+struct CallsFunction<CompiledForExpression<RefID, Begin, End, Body>, Name>
+  : std::disjunction<CallsFunction<Begin, Name>, CallsFunction<End, Name>, CallsFunction<Body, Name>> {};
+
+template<typename Condition, typename Then, typename Else, string_t Name>
+struct CallsFunction<CompiledIfExpression<Condition, Then, Else>, Name>
+  : std::disjunction<CallsFunction<Condition, Name>, CallsFunction<Then, Name>, CallsFunction<Else, Name>> {};
+
+template<typename... Arguments, string_t Name>
+struct CallsFunction<CompiledTailCallExpression<ParameterPack<Arguments...>>, Name>
+  : std::disjunction<CallsFunction<Arguments, Name>...> {};
+
+template<typename Declaration, typename Declarations, typename Bindings>
+struct DeclarationType;
+
+template<std::size_t RefID, typename Type, typename Declarations, typename Bindings>
+struct DeclarationType<CompiledVariableDeclarationExpression<RefID, Type>, Declarations, Bindings> {
+  using type = Type;
+};
+
+template<std::size_t RefID, typename Type, typename Initializer, typename Declarations, typename Bindings>
+struct DeclarationType<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>, Declarations,
+  Bindings> {
+  using type = Type;
+};
+
+// Type of a variable holding values of type T, string views (string literals) are stored as owned strings
+template<typename T>
+struct VariableType {
+  using type = std::remove_cvref_t<T>;
+};
+
+template<typename T> requires std::same_as<std::remove_cvref_t<T>, std::string_view>
+struct VariableType<T> {
+  using type = std::string;
+};
+
+template<std::size_t RefID, typename Initializer, typename Declarations, typename Bindings>
+struct DeclarationType<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>, Declarations,
+  Bindings> {
+  using type = typename VariableType<
+    decltype(Executor<Initializer>{}(std::declval<InferenceFrame<Declarations, Bindings> &>()))>::type;
+};
+
+// The loop variable has the common type of both bounds
+template<std::size_t RefID, typename Begin, typename End, typename Body, typename Declarations, typename Bindings>
+struct DeclarationType<CompiledForExpression<RefID, Begin, End, Body>, Declarations, Bindings> {
+  using type = typename VariableType<std::common_type_t<
+    decltype(Executor<Begin>{}(std::declval<InferenceFrame<Declarations, Bindings> &>())),
+    decltype(Executor<End>{}(std::declval<InferenceFrame<Declarations, Bindings> &>()))>>::type;
+};
+
+template<typename Declarations, typename Bindings, std::size_t RefID>
+struct SlotType {
+  using declaration = parameter_pack_element_t<RefID, Declarations>;
+  static_assert(declaration::ref_id == RefID, "Declarations must be ordered by ref_id");
+  using type = typename DeclarationType<declaration, Declarations, Bindings>::type;
+};
+
+// Frame used only in unevaluated context to deduce types of auto variables, slot types are resolved lazily, so an
+// initializer depends only on the variables it actually reads
+template<typename Declarations, typename Bindings>
+struct InferenceFrame : Bindings {
+  using bindings = Bindings;
+
+  template<std::size_t RefID>
+  typename SlotType<Declarations, Bindings, RefID>::type &get();
+};
+
+// Definition of the function called `Name` among the functions a script defines, void if there is none
+template<string_t Name, typename Functions>
+struct UserFunction;
+
+template<string_t Name, typename... Functions>
+struct UserFunction<Name, ParameterPack<Functions...>> {
+  static constexpr std::array<bool, sizeof...(Functions)> matches{(Functions::name == Name)...};
+  static constexpr auto index = static_cast<std::size_t>(std::ranges::find(matches, true) - matches.begin());
+  using type = pack_element_t<index, Functions..., void>;
+};
+
+// Functions of a script are called by name, so they can neither share a name nor replace builtin or host functions
+template<typename Functions, typename HostFunctions>
+struct UserFunctionNames;
+
+template<typename... Functions, typename HostFunctions>
+struct UserFunctionNames<ParameterPack<Functions...>, HostFunctions> {
+  static constexpr bool distinct = []() {
+    std::array<std::string_view, sizeof...(Functions)> names{
+      std::string_view{Functions::name.data.data(), Functions::name.Size}...};
+    std::ranges::sort(names);
+    return std::ranges::adjacent_find(names) == names.end();
+  }();
+  static constexpr bool shadow_nothing = ((!Builtin<Functions::name> &&
+                                           !HostFunctions::template contains<Functions::name>) && ...);
+};
+
+// Host functions and host variables a script is executed with, and the functions the script defines
+template<typename Functions, typename Variables, typename UserFunctions>
+struct HostBindings {
+  using user_functions = UserFunctions;
+
+  Functions &functions;
+  Variables &variables;
+};
+
+// Frame of a running script or of a function it called together with the host bindings
+template<typename Slots, typename Bindings>
+struct HostFrame : Slots, Bindings {
+  using bindings = Bindings;
+};
+
+// Frame of a function making tail calls, a tail call replaces the parameters and sets `restart`, so the function runs
+// its body again instead of returning the value of type `ReturnType` that the tail call produced
+template<typename Base, typename ReturnType>
+struct LoopingFrame : Base {
+  using return_type = ReturnType;
+
+  bool restart{};
+};
+
+template<typename Declarations, typename Bindings, typename Indices>
+struct FrameLayout;
+
+template<typename Declarations, typename Bindings, std::size_t... RefIDs>
+struct FrameLayout<Declarations, Bindings, std::index_sequence<RefIDs...>> {
+  using type = HostFrame<Frame<typename SlotType<Declarations, Bindings, RefIDs>::type...>, Bindings>;
+};
+
+template<std::size_t Size, typename Body>
+struct Executor<CompiledFrame<Size, Body>> {
+  using declarations = typename CompiledDeclarations<Body>::type;
+
+  using user_functions = typename CompiledFunctions<Body>::type;
+
+  template<typename Functions, typename Variables>
+  AMSL_INLINE static auto operator()(Functions &functions, Variables &variables) {
+    static_assert(UserFunctionNames<user_functions, Functions>::distinct, "Function is declared more than once");
+    static_assert(UserFunctionNames<user_functions, Functions>::shadow_nothing,
+                  "Functions of the script can not replace builtin or host functions");
+    using bindings = HostBindings<Functions, Variables, user_functions>;
+    OutputScope<WritesOutput<Body>::value> output_scope{};
+    typename FrameLayout<declarations, bindings, std::make_index_sequence<Size>>::type local_frame{
+      {}, bindings{functions, variables}};
+    return Executor<Body>{}(local_frame);
   }
 };
 
-template<typename Expression>
-struct Executor<CompiledExpressionList<ParameterPack<Expression>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    return Executor<Expression>{}(std::forward<LocalScopeArgs>(args)...);
+template<typename... Expressions>
+struct Executor<CompiledExpressionList<ParameterPack<Expressions...>>> {
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    return execute(frame, std::make_index_sequence<sizeof...(Expressions) - 1>{});
+  }
+
+private:
+  template<typename Frame, std::size_t... Idx>
+  AMSL_INLINE static decltype(auto) execute(Frame &frame, std::index_sequence<Idx...>) {
+    (static_cast<void>(Executor<pack_element_t<Idx, Expressions...>>{}(frame)), ...);
+    return Executor<pack_element_t<sizeof...(Idx), Expressions...>>{}(frame);
   }
 };
 
 template<>
 struct Executor<CompiledExpressionList<ParameterPack<>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static auto operator()(LocalScopeArgs &&... args) {
+  template<typename Frame>
+  AMSL_INLINE static auto operator()(Frame &) {
     return;
   }
 };
 
-template<typename Initializer, typename... Expressions>
-struct Executor<CompiledExpressionList<ParameterPack<CompiledVariableDeclarationWithInitializerAutoTypeExpression<Initializer>, Expressions...>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    auto value = Executor<Initializer>{}(std::forward<LocalScopeArgs>(args)...);
-    return Executor<CompiledExpressionList<ParameterPack<Expressions...>>>{}(std::forward<LocalScopeArgs>(args)...,
-                                                                             take_ref(value));
+template<std::size_t RefID, typename Initializer>
+struct Executor<CompiledVariableDeclarationWithInitializerAutoTypeExpression<RefID, Initializer>> {
+  template<typename Frame>
+  AMSL_INLINE static void operator()(Frame &frame) {
+    frame.template get<RefID>() = Executor<Initializer>{}(frame);
   }
 };
 
-template<typename Type, typename Initializer, typename... Expressions>
-struct Executor<CompiledExpressionList<ParameterPack<CompiledVariableDeclarationWithInitializerExpression<Type, Initializer>, Expressions...>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    Type value = Executor<Initializer>{}(std::forward<LocalScopeArgs>(args)...);
-    return Executor<CompiledExpressionList<ParameterPack<Expressions...>>>{}(std::forward<LocalScopeArgs>(args)...,
-                                                                             take_ref(value));
+template<std::size_t RefID, typename Type, typename Initializer>
+struct Executor<CompiledVariableDeclarationWithInitializerExpression<RefID, Type, Initializer>> {
+  template<typename Frame>
+  AMSL_INLINE static void operator()(Frame &frame) {
+    frame.template get<RefID>() = Executor<Initializer>{}(frame);
   }
 };
 
-template<typename Type, typename... Expressions>
-struct Executor<CompiledExpressionList<ParameterPack<CompiledVariableDeclarationExpression<Type>, Expressions...>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    Type value{};
-    return Executor<CompiledExpressionList<ParameterPack<Expressions...>>>{}(std::forward<LocalScopeArgs>(args)...,
-                                                                             take_ref(value));
+template<std::size_t RefID, typename Type>
+struct Executor<CompiledVariableDeclarationExpression<RefID, Type>> {
+  template<typename Frame>
+  AMSL_INLINE static void operator()(Frame &frame) {
+    frame.template get<RefID>() = Type{};
   }
 };
 
 template<string_t Name, typename... Parameters>
 struct Executor<CompiledFunctionCallExpression<Name, ParameterPack<Parameters...>>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    return BuiltinFunction<Name>{}(Executor<Parameters>{}(std::forward<LocalScopeArgs>(args)...)...);
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    using bindings = typename Frame::bindings;
+    using user_function = typename UserFunction<Name, typename bindings::user_functions>::type;
+    if constexpr (!std::is_void_v<user_function>)
+      return Executor<user_function>::call(static_cast<bindings &>(frame), Executor<Parameters>{}(frame)...);
+    else if constexpr (std::remove_cvref_t<decltype(frame.functions)>::template contains<Name>)
+      return frame.functions.template get<Name>()(Executor<Parameters>{}(frame)...);
+    else if constexpr (OutputBuiltin<Name>)
+      return BuiltinFunction<Name>{}(output_argument<Parameters>(frame)...);
+    else
+      return BuiltinFunction<Name>{}(Executor<Parameters>{}(frame)...);
+  }
+
+private:
+  template<typename Parameter, typename Frame>
+  AMSL_INLINE static decltype(auto) output_argument(Frame &frame) {
+    if constexpr (requires { Executor<Parameter>::formatted(frame); })
+      return Executor<Parameter>::formatted(frame);
+    else
+      return Executor<Parameter>{}(frame);
+  }
+};
+
+// The format string is a template parameter, it is parsed at compile time into the pieces written between the
+// arguments and the capacity of the result is reserved up front
+template<auto N, string_t<N> Pattern, typename... Parameters>
+struct Executor<CompiledFunctionCallExpression<"format", ParameterPack<CompiledLiteral<string_t<N>, Pattern>,
+                                                                        Parameters...>>> {
+  using format = FormatString<Pattern>;
+  static_assert(format::shape.valid, "Unmatched brace in format string, literal braces are written as {{ and }}");
+  static_assert(format::shape.placeholders == sizeof...(Parameters),
+                "Format string placeholders do not match the number of arguments");
+
+  template<typename Frame>
+  AMSL_INLINE static std::string operator()(Frame &frame) {
+    return formatted(frame).to_string();
+  }
+
+  // Evaluated arguments, in order, kept by reference when they are variables
+  template<typename Frame>
+  AMSL_INLINE static auto formatted(Frame &frame) {
+    return Formatted<format, decltype(Executor<Parameters>{}(frame))...>{{Executor<Parameters>{}(frame)...}};
   }
 };
 
 template<typename Lhs, typename Rhs>
 struct Executor<CompiledAssignmentExpression<Lhs, Rhs>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    return Executor<Lhs>{}(std::forward<LocalScopeArgs>(args)...) = Executor<Rhs>{}(
-      std::forward<LocalScopeArgs>(args)...);
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    return Executor<Lhs>{}(frame) = Executor<Rhs>{}(frame);
   }
 };
 
 template<typename T, T Value>
 struct Executor<CompiledLiteral<T, Value>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static auto operator()(LocalScopeArgs &&... args) {
+  template<typename Frame>
+  AMSL_INLINE static auto operator()(Frame &) {
     return Value;
   }
 };
 
+// Served from the static storage of the template parameter object, a std::string is constructed only when the literal
+// is stored in a variable
 template<auto N, string_t<N> Value>
 struct Executor<CompiledLiteral<string_t<N>, Value>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static auto operator()(LocalScopeArgs &&... args) {
-    return std::string{Value.c_str()};
+  template<typename Frame>
+  AMSL_INLINE static std::string_view operator()(Frame &) {
+    return {Value.c_str(), Value.size()};
   }
 };
 
 template<std::size_t RefID>
 struct Executor<CompiledVariableExpression<RefID>> {
-  template<typename ... LocalScopeArgs>
-  AMSL_INLINE static decltype(auto) operator()(LocalScopeArgs &&... args) {
-    return get_last_nth_argument<RefID>(std::forward<LocalScopeArgs>(args)...);
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    return frame.template get<RefID>();
+  }
+};
+
+// Last read of the variable, its value is handed over instead of copied and dies with the expression reading it
+template<std::size_t RefID>
+struct Executor<CompiledMovedVariableExpression<RefID>> {
+  template<typename Frame>
+  AMSL_INLINE static auto operator()(Frame &frame) {
+    return std::move(frame.template get<RefID>());
+  }
+};
+
+// Function of the script named where a value is expected (an argument of the array builtins), calling it calls the
+// function with the host bindings of the script. Functions that may share state between calls are not called
+// concurrently
+template<typename Function, typename Bindings>
+struct ScriptFunctionReference {
+  static constexpr bool concurrent = !SharesState<Function>::value;
+
+  Bindings &bindings;
+
+  template<typename... Args>
+  AMSL_INLINE decltype(auto) operator()(Args &&... args) const {
+    return Executor<Function>::call(bindings, std::forward<Args>(args)...);
+  }
+};
+
+// Names the script does not declare are host variables, or else functions of the script or of the host
+template<string_t Name>
+struct Executor<CompiledHostVariableExpression<Name>> {
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    using bindings = typename Frame::bindings;
+    using user_function = typename UserFunction<Name, typename bindings::user_functions>::type;
+    constexpr bool variable = std::remove_cvref_t<decltype(frame.variables)>::template contains<Name>;
+    constexpr bool host_function = std::remove_cvref_t<decltype(frame.functions)>::template contains<Name>;
+    static_assert(variable || !std::is_void_v<user_function> || host_function,
+                  "Variable is neither declared by the script nor bound by the host");
+    if constexpr (variable)
+      return frame.variables.template get<Name>();
+    else if constexpr (!std::is_void_v<user_function>)
+      return ScriptFunctionReference<user_function, bindings>{static_cast<bindings &>(frame)};
+    else
+      return frame.functions.template get<Name>();
+  }
+};
+
+template<typename Condition, typename Body>
+struct Executor<CompiledWhileExpression<Condition, Body>> {
+  template<typename Frame>
+  AMSL_INLINE static void operator()(Frame &frame) {
+    while (Executor<Condition>{}(frame))
+      static_cast<void>(Executor<Body>{}(frame));
+  }
+};
+
+template<typename Expression>
+inline constexpr bool is_integral_literal = false;
+
+template<std::integral T, T Value>
+inline constexpr bool is_integral_literal<CompiledLiteral<T, Value>> = true;
+
+// Lowered to a plain counted loop, the end is evaluated once before the first iteration. A loop over literal bounds
+// whose body does not write the loop variable is fully unrolled when it is short enough, the loop variable is then a
+// constant in every copy of the body
+template<std::size_t RefID, typename Begin, typename End, typename Body>
+struct Executor<CompiledForExpression<RefID, Begin, End, Body>> {
+  template<typename Frame>
+  AMSL_INLINE static void operator()(Frame &frame) {
+    auto &index = frame.template get<RefID>();
+    if constexpr (unrolled_iterations() >= 0) {
+      index = Begin::value;
+      execute_unrolled(frame, index, std::make_index_sequence<unrolled_iterations()>{});
+    } else {
+      index = Executor<Begin>{}(frame);
+      auto end = Executor<End>{}(frame);
+      for (; index < end; ++index)
+        static_cast<void>(Executor<Body>{}(frame));
+    }
+  }
+
+private:
+  // Trip count of an unrolled loop, -1 if the loop is not unrolled
+  static consteval std::int64_t unrolled_iterations() {
+    if constexpr (is_integral_literal<Begin> && is_integral_literal<End> && !WritesVariable<Body, RefID>::value) {
+      auto iterations = std::max<std::int64_t>(static_cast<std::int64_t>(End::value) - Begin::value, 0);
+      return iterations <= AMSL_MAX_UNROLLED_ITERATIONS ? iterations : -1;
+    } else
+      return -1;
+  }
+
+  template<typename Frame, typename Index, std::size_t... Idx>
+  AMSL_INLINE static void execute_unrolled(Frame &frame, Index &index, std::index_sequence<Idx...>) {
+    ((static_cast<void>(Idx), static_cast<void>(Executor<Body>{}(frame)), ++index), ...);
+  }
+};
+
+// Value of an if expression whose branches produce values of types `Then` and `Else`: the branches' own type if they
+// agree, else the type both can be stored in. Branches without a common type leave the if expression without a value
+template<typename Then, typename Else>
+struct BranchesType {
+  using type = void;
+};
+
+template<typename T>
+struct BranchesType<T, T> {
+  using type = T;
+};
+
+template<typename Then, typename Else> requires (!std::is_void_v<Then> && !std::is_void_v<Else> &&
+  requires { typename std::common_type_t<typename VariableType<Then>::type, typename VariableType<Else>::type>; })
+struct BranchesType<Then, Else> {
+  using type = std::common_type_t<typename VariableType<Then>::type, typename VariableType<Else>::type>;
+};
+
+template<typename Condition, typename Then, typename Else>
+struct Executor<CompiledIfExpression<Condition, Then, Else>> {
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    using type = typename BranchesType<decltype(Executor<Then>{}(frame)), decltype(Executor<Else>{}(frame))>::type;
+    if constexpr (std::is_void_v<type>) {
+      if (Executor<Condition>{}(frame))
+        static_cast<void>(Executor<Then>{}(frame));
+      else
+        static_cast<void>(Executor<Else>{}(frame));
+    } else {
+      if (Executor<Condition>{}(frame))
+        return static_cast<type>(Executor<Then>{}(frame));
+      return static_cast<type>(Executor<Else>{}(frame));
+    }
+  }
+};
+
+// A condition folded to a literal picks its branch at compile time, the other one is never instantiated
+template<typename T, T Value, typename Then, typename Else>
+struct Executor<CompiledIfExpression<CompiledLiteral<T, Value>, Then, Else>> {
+  template<typename Frame>
+  AMSL_INLINE static decltype(auto) operator()(Frame &frame) {
+    if constexpr (static_cast<bool>(Value))
+      return Executor<Then>{}(frame);
+    else
+      return Executor<Else>{}(frame);
+  }
+};
+
+// All the arguments are evaluated before any parameter (ref_ids 0 to N - 1 of the function's frame) is replaced. The
+// value returned is discarded by the function, which runs its body again
+template<typename... Arguments>
+struct Executor<CompiledTailCallExpression<ParameterPack<Arguments...>>> {
+  template<typename Frame>
+  AMSL_INLINE static auto operator()(Frame &frame) {
+    restart(frame, std::tuple<typename VariableType<decltype(Executor<Arguments>{}(frame))>::type...>{
+      Executor<Arguments>{}(frame)...}, std::index_sequence_for<Arguments...>{});
+    return typename Frame::return_type{};
+  }
+
+private:
+  template<typename Frame, typename Values, std::size_t... Idx>
+  AMSL_INLINE static void restart(Frame &frame, Values &&values, std::index_sequence<Idx...>) {
+    ((frame.template get<Idx>() = std::get<Idx>(std::move(values))), ...);
+    frame.restart = true;
+  }
+};
+
+// Parameter of a function called with an argument of type `Argument`, a parameter declared without a type has the
+// type the argument would be stored in
+template<typename Parameter, typename Argument>
+struct BoundParameter {
+  using type = Parameter;
+};
+
+template<std::size_t RefID, typename Argument>
+struct BoundParameter<CompiledVariableDeclarationExpression<RefID, InferredType>, Argument> {
+  using type = CompiledVariableDeclarationExpression<RefID, typename VariableType<Argument>::type>;
+};
+
+// Type a function returns: the declared one, or the decayed type of the value of its body. The type of a recursive
+// function's body depends on the type of the function
+template<typename ReturnType, typename Body, typename Frame, bool Recursive>
+struct FunctionResult {
+  using type = ReturnType;
+};
+
+template<typename Body, typename Frame, bool Recursive>
+struct FunctionResult<InferredType, Body, Frame, Recursive> {
+  static_assert(!Recursive, "Recursive functions have to declare their return type");
+  using type = std::decay_t<decltype(Executor<Body>{}(std::declval<Frame &>()))>;
+};
+
+// The definition does nothing where it stands. Every call instantiates the function for the types of its arguments
+// with a frame of its own (parameters first, then the locals) sharing the host bindings of the caller, and is inlined
+// into it like the code it was factored out of. The value of the body is returned by value. Self tail calls restart
+// the body in the same frame, so tail recursion runs as a loop. A function that still calls itself is called through
+// a function that is not forced inline, it can not be inlined into itself
+template<string_t Name, typename ReturnType, typename... Parameters, std::size_t Size, typename Body>
+struct Executor<CompiledFunctionExpression<Name, ReturnType, ParameterPack<Parameters...>, Size, Body>> {
+  static constexpr bool recursive = CallsFunction<Body, Name>::value;
+
+  template<typename Bindings, typename... Args>
+  using host_frame = typename FrameLayout<parameter_pack_concat_t<
+    ParameterPack<typename BoundParameter<Parameters, Args>::type...>, typename CompiledDeclarations<Body>::type>,
+    Bindings, std::make_index_sequence<Size>>::type;
+
+  template<typename Bindings, typename... Args>
+  using result_type = typename FunctionResult<ReturnType, Body, host_frame<Bindings, Args...>,
+    recursive || MakesTailCall<Body>::value>::type;
+
+  template<typename Frame>
+  AMSL_INLINE static void operator()(Frame &) {}
+
+  template<typename Bindings, typename... Args>
+  AMSL_INLINE static result_type<Bindings, Args...> call(Bindings &bindings, Args &&... args) {
+    static_assert(sizeof...(Args) == sizeof...(Parameters), "Function is called with a wrong number of arguments");
+    if constexpr (recursive)
+      return call_recursive(bindings, std::forward<Args>(args)...);
+    else
+      return execute(bindings, std::forward<Args>(args)...);
+  }
+
+private:
+  template<typename Bindings, typename... Args>
+  static result_type<Bindings, Args...> call_recursive(Bindings &bindings, Args &&... args) {
+    return execute(bindings, std::forward<Args>(args)...);
+  }
+
+  template<typename Bindings, typename... Args>
+  AMSL_INLINE static result_type<Bindings, Args...> execute(Bindings &bindings, Args &&... args) {
+    using result = result_type<Bindings, Args...>;
+    if constexpr (MakesTailCall<Body>::value) {
+      LoopingFrame<host_frame<Bindings, Args...>, result> frame{{{}, bindings}};
+      ((frame.template get<Parameters::ref_id>() = std::forward<Args>(args)), ...);
+      for (;;) {
+        auto value = static_cast<result>(Executor<Body>{}(frame));
+        if (!frame.restart)
+          return value;
+        frame.restart = false;
+      }
+    } else {
+      host_frame<Bindings, Args...> frame{{}, bindings};
+      ((frame.template get<Parameters::ref_id>() = std::forward<Args>(args)), ...);
+      return static_cast<result>(Executor<Body>{}(frame));
+    }
   }
 };
 
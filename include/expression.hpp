@@ -1,219 +1,155 @@
 #ifndef AMSL_EXPRESSION_HPP
 #define AMSL_EXPRESSION_HPP
 
-#include <utility>
-#include <vector>
-#include <optional>
 #include <string>
-#include <ranges>
-#include "ptr_wrapper.hpp"
-#include "analyzed_expression.hpp"
+#include <string_view>
+#include "node_arena.hpp"
+#include "utils.hpp"
 
-struct AnalyzerScope {
-  std::vector<std::string> variable_declarations{};
-};
-
-struct AnalyzerState {
-  std::vector<AnalyzerScope> scopes{};
-
-  constexpr AnalyzerScope &current_scope() {
-    return scopes.back();
-  }
+// Names and types are views into the source code, so the tree is only valid while the source code is alive
 
-  constexpr std::size_t get_variable_ref_id(const std::string &name) {
-    std::size_t ref_id{};
-    for (const auto &scope: scopes | std::views::reverse) {
-      auto it = std::find(scope.variable_declarations.begin(), scope.variable_declarations.end(), name);
-      if (it == scope.variable_declarations.end())
-        ref_id += scope.variable_declarations.size();
-      else
-        return ref_id + std::distance(it, scope.variable_declarations.end()) - 1;
-    }
-    return std::string::npos;
-  }
+struct ExpressionList {
+  NodeRange expressions{};
 };
 
-struct Expression {
-  constexpr virtual ~Expression() = default;
-
-  [[nodiscard]] constexpr virtual ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const = 0;
-
-  [[nodiscard]] constexpr virtual std::string as_string() const = 0;
+struct FunctionCallExpression {
+  std::string_view name{};
+  NodeRange parameters{};
 };
 
-struct ExpressionList : public Expression {
-  std::vector<ptr_wrapper<Expression>> expressions;
-
-  constexpr explicit ExpressionList(std::vector<ptr_wrapper<Expression>> &&expressions = {}) : expressions{
-    std::move(expressions)} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    std::vector<ptr_wrapper<AnalyzedExpression>> analyzed_expressions;
-    state.scopes.emplace_back();
-    for (const auto &expression: expressions)
-      analyzed_expressions.push_back(expression->analyze(state));
-    state.scopes.pop_back();
-    return make_ptr_wrapper<AnalyzedExpressionList>(std::move(analyzed_expressions));
-  }
-
-  [[nodiscard]] constexpr std::string as_string() const override {
-    std::string str = "ExpressionList(expressions=[";
-    for (std::size_t idx = 0; idx < expressions.size(); ++idx) {
-      if (idx)
-        str += ", ";
-      str += expressions[idx]->as_string();
-    }
-    return str + "])";
-  }
+struct VariableDeclarationExpression {
+  std::string_view name{};
+  std::string_view type{};
 };
 
-struct FunctionCallExpression : public Expression {
-  std::string name;
-  std::vector<ptr_wrapper<Expression>> parameters;
-
-  constexpr explicit FunctionCallExpression(std::string name,
-                                            std::vector<ptr_wrapper<Expression>> &&parameters = {}) : name{name},
-                                                                                                      parameters{
-                                                                                                        std::move(
-                                                                                                          parameters)} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    std::vector<ptr_wrapper<AnalyzedExpression>> analyzed_parameters;
-    for (const auto &parameter: parameters) {
-      state.scopes.emplace_back();
-      analyzed_parameters.push_back(parameter->analyze(state));
-      state.scopes.pop_back();
-    }
-    return make_ptr_wrapper<AnalyzedFunctionCallExpression>(name, std::move(analyzed_parameters));
-  }
-
-  [[nodiscard]] constexpr std::string as_string() const override {
-    std::string str = "FunctionCallExpression(name='" + name + "', parameters=[";
-    for (std::size_t idx = 0; idx < parameters.size(); ++idx) {
-      if (idx)
-        str += ", ";
-      str += parameters[idx]->as_string();
-    }
-    return str + "])";
-  }
+struct VariableDeclarationWithInitializerExpression {
+  std::string_view name{};
+  std::string_view type{};
+  NodeIndex initializer{no_node};
 };
 
-struct VariableDeclarationExpression : public Expression {
-  std::string name{};
-  std::string type{};
-
-  constexpr explicit VariableDeclarationExpression(std::string name, std::string type)
-    : name{name}, type{type} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    state.current_scope().variable_declarations.push_back(name);
-    return make_ptr_wrapper<AnalyzedVariableDeclarationExpression>(type);
-  }
-
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "VariableDeclarationExpression(name='" + name + "', type='" + type + "')";
-  }
+struct VariableDeclarationWithInitializerAutoTypeExpression {
+  std::string_view name{};
+  NodeIndex initializer{no_node};
 };
 
-struct VariableDeclarationWithInitializerExpression : public Expression {
-  std::string name{};
-  std::string type{};
-  ptr_wrapper<Expression> initializer{};
-
-  constexpr explicit VariableDeclarationWithInitializerExpression(std::string name, std::string type,
-                                                                  ptr_wrapper<Expression> &&initializer)
-    : name{name}, type{type}, initializer{std::move(initializer)} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    state.scopes.emplace_back();
-    auto analyzed_initializer = initializer->analyze(state);
-    state.scopes.pop_back();
-    state.current_scope().variable_declarations.push_back(name);
-    return make_ptr_wrapper<AnalyzedVariableDeclarationWithInitializerExpression>(type,
-                                                                                  std::move(analyzed_initializer));
-  }
-
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "VariableDeclarationWithInitializerExpression(name='" + name + "', type='" + type + "', initializer=" +
-           initializer->as_string() + ")";
-  }
+struct VariableExpression {
+  std::string_view name{};
 };
 
-struct VariableDeclarationWithInitializerAutoTypeExpression : public Expression {
-  std::string name{};
-  ptr_wrapper<Expression> initializer{};
-
-  constexpr explicit VariableDeclarationWithInitializerAutoTypeExpression(std::string name,
-                                                                          ptr_wrapper<Expression> &&initializer)
-    : name{name}, initializer{std::move(initializer)} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    state.scopes.emplace_back();
-    auto analyzed_initializer = initializer->analyze(state);
-    state.scopes.pop_back();
-    state.current_scope().variable_declarations.push_back(name);
-    return make_ptr_wrapper<AnalyzedVariableDeclarationWithInitializerAutoTypeExpression>(
-      std::move(analyzed_initializer));
-  }
-
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "VariableDeclarationWithInitializerAutoTypeExpression(name='" + name + "', initializer=" +
-           initializer->as_string() + ")";
-  }
+struct AssignmentExpression {
+  NodeIndex lhs{no_node};
+  NodeIndex rhs{no_node};
 };
 
-struct VariableExpression : public Expression {
-  std::string name;
-
-  constexpr explicit VariableExpression(std::string name) : name{name} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    return make_ptr_wrapper<AnalyzedVariableExpression>(state.get_variable_ref_id(name));
-  }
+// `while <condition> <body>`, the body is repeated as long as the condition converts to true
+struct WhileExpression {
+  NodeIndex condition{no_node};
+  NodeIndex body{no_node};
+};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "VariableExpression(name='" + name + "')";
-  }
+// `for <name> in <begin>..<end> <body>`, the body is repeated for every value of the half-open range
+struct ForExpression {
+  std::string_view name{};
+  NodeIndex begin{no_node};
+  NodeIndex end{no_node};
+  NodeIndex body{no_node};
 };
 
-struct AssignmentExpression : public Expression {
-  ptr_wrapper<Expression> lhs;
-  ptr_wrapper<Expression> rhs;
-
-  constexpr explicit AssignmentExpression(ptr_wrapper<Expression> &&lhs, ptr_wrapper<Expression> &&rhs) : lhs{
-    std::move(lhs)}, rhs{std::move(rhs)} {}
-
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    state.scopes.emplace_back();
-    auto analyzed_lhs = lhs->analyze(state);
-    state.scopes.pop_back();
-    state.scopes.emplace_back();
-    auto analyzed_rhs = rhs->analyze(state);
-    state.scopes.pop_back();
-    return make_ptr_wrapper<AnalyzedAssignmentExpression>(std::move(analyzed_lhs), std::move(analyzed_rhs));
-  }
+// `if <condition> <then_branch> [else <else_branch>]`, `else_branch` is no_node without an else
+struct IfExpression {
+  NodeIndex condition{no_node};
+  NodeIndex then_branch{no_node};
+  NodeIndex else_branch{no_node};
+};
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    return "AssignmentExpression(lhs=" + lhs->as_string() + ", rhs=" + rhs->as_string() + ")";
-  }
+// `[(<parameters>) -> <return_type> <body>]`, parameters are declarations without an initializer. Omitted parameter
+// and return types are empty
+struct FunctionExpression {
+  NodeRange parameters{};
+  std::string_view return_type{};
+  NodeIndex body{no_node};
 };
 
 template<typename T>
-struct LiteralExpression : public Expression {
-  T value;
-
-  constexpr explicit LiteralExpression(const T &value) : value{value} {}
+struct LiteralExpression {
+  T value{};
+};
 
-  [[nodiscard]] constexpr ptr_wrapper<AnalyzedExpression> analyze(AnalyzerState &state) const override {
-    return make_ptr_wrapper<AnalyzedLiteralExpression<T>>(value);
-  }
+using ExpressionTree = NodeArena<ExpressionList, FunctionCallExpression, VariableDeclarationExpression,
+  VariableDeclarationWithInitializerExpression, VariableDeclarationWithInitializerAutoTypeExpression,
+  VariableExpression, AssignmentExpression, LiteralExpression<int>, LiteralExpression<EscapedString>, WhileExpression,
+  ForExpression, IfExpression, FunctionExpression>;
+
+constexpr std::string as_string(const ExpressionTree &tree, NodeIndex index);
+
+constexpr std::string as_string(const ExpressionTree &tree, std::span<const NodeIndex> indices) {
+  std::string str{};
+  for (std::size_t idx = 0; idx < indices.size(); ++idx) {
+    if (idx)
+      str += ", ";
+    str += as_string(tree, indices[idx]);
+  }
+  return str;
+}
+
+constexpr std::string as_string(const ExpressionTree &tree, NodeIndex index) {
+  return tree.visit(index, Overload{
+    [&tree](const ExpressionList &node) {
+      return "ExpressionList(expressions=[" + as_string(tree, tree[node.expressions]) + "])";
+    },
+    [&tree](const FunctionCallExpression &node) {
+      return "FunctionCallExpression(name='" + std::string{node.name} + "', parameters=[" +
+             as_string(tree, tree[node.parameters]) + "])";
+    },
+    [](const VariableDeclarationExpression &node) {
+      return "VariableDeclarationExpression(name='" + std::string{node.name} + "', type='" + std::string{node.type} +
+             "')";
+    },
+    [&tree](const VariableDeclarationWithInitializerExpression &node) {
+      return "VariableDeclarationWithInitializerExpression(name='" + std::string{node.name} + "', type='" +
+             std::string{node.type} + "', initializer=" + as_string(tree, node.initializer) + ")";
+    },
+    [&tree](const VariableDeclarationWithInitializerAutoTypeExpression &node) {
+      return "VariableDeclarationWithInitializerAutoTypeExpression(name='" + std::string{node.name} +
+             "', initializer=" + as_string(tree, node.initializer) + ")";
+    },
+    [](const VariableExpression &node) {
+      return "VariableExpression(name='" + std::string{node.name} + "')";
+    },
+    [&tree](const AssignmentExpression &node) {
+      return "AssignmentExpression(lhs=" + as_string(tree, node.lhs) + ", rhs=" + as_string(tree, node.rhs) + ")";
+    },
+    [](const LiteralExpression<int> &node) {
+      return "LiteralExpression(value=" + int_to_string(node.value) + ")";
+    },
+    [](const LiteralExpression<EscapedString> &node) {
+      return "LiteralExpression(value='" + unescape(node.value.text) + "')";
+    },
+    [&tree](const WhileExpression &node) {
+      return "WhileExpression(condition=" + as_string(tree, node.condition) + ", body=" + as_string(tree, node.body) +
+             ")";
+    },
+    [&tree](const ForExpression &node) {
+      return "ForExpression(name='" + std::string{node.name} + "', begin=" + as_string(tree, node.begin) + ", end=" +
+             as_string(tree, node.end) + ", body=" + as_string(tree, node.body) + ")";
+    },
+    [&tree](const IfExpression &node) {
+      auto str = "IfExpression(condition=" + as_string(tree, node.condition) + ", then_branch=" +
+                 as_string(tree, node.then_branch);
+      if (node.else_branch != no_node)
+        str += ", else_branch=" + as_string(tree, node.else_branch);
+      return str + ")";
+    },
+    [&tree](const FunctionExpression &node) {
+      return "FunctionExpression(parameters=[" + as_string(tree, tree[node.parameters]) + "], return_type='" +
+             std::string{node.return_type} + "', body=" + as_string(tree, node.body) + ")";
+    }
+  });
+}
 
-  [[nodiscard]] constexpr std::string as_string() const override {
-    if constexpr (std::is_same_v<T, int>)
-      return std::string{"LiteralExpression(value="} + int_to_string(value) + ")";
-    else
-      return std::string{"LiteralExpression(value='"} + value + "')";
-  }
-};
+constexpr std::string as_string(const ExpressionTree &tree) {
+  return as_string(tree, tree.root);
+}
 
 #endif // AMSL_EXPRESSION_HPP
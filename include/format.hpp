@@ -0,0 +1,169 @@
+#ifndef AMSL_FORMAT_HPP
+#define AMSL_FORMAT_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "output.hpp"
+#include "string.hpp"
+#include "utils.hpp"
+
+// Format strings of `@format` replace every `{}` with the next argument, `{{` and `}}` stand for literal braces
+
+struct FormatShape {
+  bool valid = true;
+  // Characters of the format string besides the placeholders, with escapes resolved
+  std::size_t text_size = 0;
+  std::size_t placeholders = 0;
+};
+
+constexpr bool is_escaped_brace(std::string_view pattern, std::size_t pos) {
+  return (pattern[pos] == '{' || pattern[pos] == '}') && pos + 1 < pattern.size() && pattern[pos + 1] == pattern[pos];
+}
+
+constexpr bool is_placeholder(std::string_view pattern, std::size_t pos) {
+  return pattern[pos] == '{' && pos + 1 < pattern.size() && pattern[pos + 1] == '}';
+}
+
+constexpr FormatShape format_shape(std::string_view pattern) {
+  FormatShape shape{};
+  for (std::size_t pos = 0; pos < pattern.size(); ++pos) {
+    if (is_placeholder(pattern, pos)) {
+      ++shape.placeholders;
+      ++pos;
+      continue;
+    }
+    if (is_escaped_brace(pattern, pos))
+      ++pos;
+    else if (pattern[pos] == '{' || pattern[pos] == '}')
+      shape.valid = false;
+    ++shape.text_size;
+  }
+  return shape;
+}
+
+// Format string parsed at compile time into the literal pieces between its placeholders, piece I is written before
+// argument I and the last one after all of them
+template<string_t Pattern>
+struct FormatString {
+  static constexpr std::string_view pattern{Pattern.data.data(), Pattern.Size};
+  static constexpr FormatShape shape = format_shape(pattern);
+
+  // Text of all pieces one after another, piece I spans [bounds[I], bounds[I + 1])
+  static constexpr auto text = [] {
+    std::array<char, shape.text_size> text{};
+    std::size_t size = 0;
+    for (std::size_t pos = 0; pos < pattern.size(); ++pos) {
+      if (is_placeholder(pattern, pos)) {
+        ++pos;
+        continue;
+      }
+      if (is_escaped_brace(pattern, pos))
+        ++pos;
+      text[size++] = pattern[pos];
+    }
+    return text;
+  }();
+
+  static constexpr auto bounds = [] {
+    std::array<std::size_t, shape.placeholders + 2> bounds{};
+    std::size_t size = 0, piece = 0;
+    for (std::size_t pos = 0; pos < pattern.size(); ++pos) {
+      if (is_placeholder(pattern, pos)) {
+        bounds[++piece] = size;
+        ++pos;
+        continue;
+      }
+      if (is_escaped_brace(pattern, pos))
+        ++pos;
+      ++size;
+    }
+    bounds[++piece] = size;
+    return bounds;
+  }();
+
+  template<std::size_t I>
+  static constexpr std::string_view piece{text.data() + bounds[I], bounds[I + 1] - bounds[I]};
+};
+
+// Upper bound of the characters `write_formatted` produces for `value`, 0 when it is not known up front
+template<typename T>
+constexpr std::size_t formatted_size_bound(const T &value) {
+  using type = std::remove_cvref_t<T>;
+  if constexpr (std::same_as<type, char> || std::same_as<type, bool>)
+    return 1;
+  else if constexpr (std::convertible_to<const T &, std::string_view>)
+    return std::string_view{value}.size();
+  else if constexpr (std::integral<type>)
+    return std::numeric_limits<type>::digits10 + 2;
+  else if constexpr (std::floating_point<type>)
+    return max_number_size;
+  else
+    return 0;
+}
+
+// Appends to a string that has its capacity reserved, numbers are formatted on the stack and copied
+class StringOutput {
+public:
+  AMSL_INLINE explicit StringOutput(std::string &string) : string{string} {}
+
+  AMSL_INLINE void put(char chr) {
+    string.push_back(chr);
+  }
+
+  AMSL_INLINE void write(std::string_view text) {
+    string.append(text);
+  }
+
+  template<typename T>
+  AMSL_INLINE void write_number(T value) {
+    char digits[max_number_size];
+    string.append(digits, format_number(digits, digits + max_number_size, value));
+  }
+
+private:
+  std::string &string;
+};
+
+// Arguments of a `@format` call, formatted into a string with a single allocation or written straight to the output
+// sink when printed
+template<typename Format, typename... Args>
+struct Formatted {
+  std::tuple<Args...> arguments;
+
+  template<typename Output>
+  AMSL_INLINE void write_to(Output &output) const {
+    write_pieces(output, std::index_sequence_for<Args...>{});
+  }
+
+  AMSL_INLINE std::string to_string() const {
+    std::string result{};
+    result.reserve(std::apply([](const auto &... args) {
+      return (Format::text.size() + ... + formatted_size_bound(args));
+    }, arguments));
+    StringOutput output{result};
+    write_to(output);
+    return result;
+  }
+
+private:
+  template<typename Output, std::size_t... Idx>
+  AMSL_INLINE void write_pieces(Output &output, std::index_sequence<Idx...>) const {
+    write_piece<0>(output);
+    ((write_formatted(output, std::get<Idx>(arguments)), write_piece<Idx + 1>(output)), ...);
+  }
+
+  template<std::size_t I, typename Output>
+  AMSL_INLINE static void write_piece(Output &output) {
+    if constexpr (!Format::template piece<I>.empty())
+      output.write(Format::template piece<I>);
+  }
+};
+
+#endif // AMSL_FORMAT_HPP
@@ -0,0 +1,52 @@
+#ifndef AMSL_FRAME_HPP
+#define AMSL_FRAME_HPP
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <utility>
+#include "traits.hpp"
+#include "utils.hpp"
+
+template<std::size_t RefID, typename T>
+struct FrameField {
+  T value{};
+};
+
+template<typename FieldOrder, typename... Slots>
+struct FrameStorage;
+
+template<std::size_t... SlotsByField, typename... Slots>
+struct FrameStorage<std::index_sequence<SlotsByField...>, Slots...>
+  : FrameField<SlotsByField, pack_element_t<SlotsByField, Slots...>> ... {
+};
+
+// Storage of all local variables of a script, variable with ref_id N has type Slots[N]
+// Fields are laid out by decreasing alignment (ties keep declaration order) to avoid padding between them
+template<typename... Slots>
+class Frame {
+public:
+  template<std::size_t RefID>
+  AMSL_INLINE constexpr auto &get() {
+    return static_cast<FrameField<RefID, pack_element_t<RefID, Slots...>> &>(storage).value;
+  }
+
+private:
+  static constexpr auto slots_by_field = []() {
+    std::array<std::size_t, sizeof...(Slots)> alignments{alignof(Slots)...};
+    std::array<std::size_t, sizeof...(Slots)> order{};
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&alignments](std::size_t lhs, std::size_t rhs) {
+      return alignments[lhs] != alignments[rhs] ? alignments[lhs] > alignments[rhs] : lhs < rhs;
+    });
+    return order;
+  }();
+
+  using field_order = decltype([]<std::size_t... Idx>(std::index_sequence<Idx...>) {
+    return std::index_sequence<slots_by_field[Idx]...>{};
+  }(std::index_sequence_for<Slots...>{}));
+
+  FrameStorage<field_order, Slots...> storage{};
+};
+
+#endif // AMSL_FRAME_HPP
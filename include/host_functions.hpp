@@ -0,0 +1,63 @@
+#ifndef AMSL_HOST_FUNCTIONS_HPP
+#define AMSL_HOST_FUNCTIONS_HPP
+
+#include <concepts>
+#include <type_traits>
+#include <utility>
+#include "builtin_functions.hpp"
+#include "string.hpp"
+#include "utils.hpp"
+
+template<string_t Name>
+concept Builtin = requires { BuiltinFunction<Name>::effect; };
+
+// Callable of the embedding code (lambda, function object or function pointer) that scripts call as `@Name(...)`
+template<string_t Name, typename Function>
+struct HostFunction {
+  Function function;
+};
+
+template<string_t Name, typename Function>
+constexpr HostFunction<Name, std::decay_t<Function>> host_function(Function &&function) {
+  return {std::forward<Function>(function)};
+}
+
+// Table of host functions passed to `AMSL::execute`, calls are resolved by name at compile time and the callables are
+// invoked directly, so they are inlined like builtin functions
+template<typename... Functions>
+struct HostFunctions;
+
+template<string_t... Names, typename... Functions>
+struct HostFunctions<HostFunction<Names, Functions>...> : HostFunction<Names, Functions> ... {
+  static_assert((!Builtin<Names> && ...), "Host functions can not replace builtin functions");
+
+  template<string_t Name>
+  static constexpr bool contains = (std::same_as<HostFunction<Name, Functions>, HostFunction<Names, Functions>> || ...);
+
+  template<string_t Name>
+  AMSL_INLINE constexpr auto &get() {
+    return function_of<Name>(*this);
+  }
+
+  template<string_t Name>
+  AMSL_INLINE constexpr const auto &get() const {
+    return function_of<Name>(*this);
+  }
+
+private:
+  // Deduced from the only base registered under `Name`, registering a name twice makes the call ambiguous
+  template<string_t Name, typename Function>
+  AMSL_INLINE static constexpr Function &function_of(HostFunction<Name, Function> &host) {
+    return host.function;
+  }
+
+  template<string_t Name, typename Function>
+  AMSL_INLINE static constexpr const Function &function_of(const HostFunction<Name, Function> &host) {
+    return host.function;
+  }
+};
+
+template<typename... Functions>
+HostFunctions(Functions...) -> HostFunctions<Functions...>;
+
+#endif // AMSL_HOST_FUNCTIONS_HPP
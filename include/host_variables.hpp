@@ -0,0 +1,45 @@
+#ifndef AMSL_HOST_VARIABLES_HPP
+#define AMSL_HOST_VARIABLES_HPP
+
+#include <concepts>
+#include "string.hpp"
+#include "utils.hpp"
+
+// Object of the embedding code that scripts use as the variable `Name` without declaring it. The object is bound by
+// reference, so scripts read and write it in place (a const object can only be read)
+template<string_t Name, typename T>
+struct HostVariable {
+  T &value;
+};
+
+template<string_t Name, typename T>
+constexpr HostVariable<Name, T> host_variable(T &value) {
+  return {value};
+}
+
+// Table of host variables passed to `AMSL::execute`, variables are resolved by name at compile time
+template<typename... Variables>
+struct HostVariables;
+
+template<string_t... Names, typename... Ts>
+struct HostVariables<HostVariable<Names, Ts>...> : HostVariable<Names, Ts> ... {
+  template<string_t Name>
+  static constexpr bool contains = (std::same_as<HostVariable<Name, Ts>, HostVariable<Names, Ts>> || ...);
+
+  template<string_t Name>
+  AMSL_INLINE constexpr auto &get() const {
+    return value_of<Name>(*this);
+  }
+
+private:
+  // Deduced from the only base registered under `Name`, registering a name twice makes the access ambiguous
+  template<string_t Name, typename T>
+  AMSL_INLINE static constexpr T &value_of(const HostVariable<Name, T> &host) {
+    return host.value;
+  }
+};
+
+template<typename... Variables>
+HostVariables(Variables...) -> HostVariables<Variables...>;
+
+#endif // AMSL_HOST_VARIABLES_HPP
@@ -3,105 +3,189 @@
 
 #include <vector>
 #include <array>
+#include <optional>
+#include <utility>
 #include "token.hpp"
+#include "char_class.hpp"
 #include "utils.hpp"
 
+enum class LexerMode : std::uint8_t {
+  START,
+  WORD,
+  ZERO,
+  INT_PREFIX,
+  INT_DIGITS,
+  STRING,
+  STRING_ESCAPE
+};
+
 struct LexerState {
-  std::size_t current_idx{};
-  std::string raw_token{};
-  bool quoted{};
-  bool escaped{};
+  LexerMode mode{LexerMode::START};
+  std::size_t token_start{};
+  IntBase base{IntBase::DECIMAL};
   std::vector<Token> tokens{};
 };
 
+// Single pass deterministic automaton: every character is classified by a lookup in `char_table` and moves the lexer
+// to its next mode, a token is pushed as soon as the character ending it is seen
 class Lexer {
 public:
   constexpr explicit Lexer(std::string_view str) : str{str} {}
 
   constexpr std::vector<Token> tokenize() {
     state = LexerState{};
-    while (state.current_idx < str.size())
-      proceed();
-    push_token();
-    return state.tokens;
+    std::size_t idx = 0;
+    while (idx < str.size())
+      idx = proceed(idx);
+    finish(str.size());
+    return std::move(state.tokens);
   }
 
 private:
-  constexpr void proceed() {
-    if (state.current_idx >= str.size())
-      return;
-
-    char chr = str[state.current_idx++];
-
-    if (state.escaped) {
-      if (chr == 'n')
-        state.raw_token += '\n';
-      else if (chr == 't')
-        state.raw_token += '\t';
-      else if (chr == 'r')
-        state.raw_token += '\r';
-      else if (chr == 'a')
-        state.raw_token += '\a';
-      else if (chr == 'f')
-        state.raw_token += '\f';
-      else if (chr == 'v')
-        state.raw_token += '\v';
-      else if (chr == 'b')
-        state.raw_token += '\b';
-      else
-        state.raw_token += chr;
-      state.escaped = false;
-    } else if (chr == '\"') {
-      push_token();
-      state.quoted = !state.quoted;
-    } else if (state.quoted) {
-      if (chr == '\\')
-        state.escaped = true;
-      else
-        state.raw_token += chr;
-    } else if (is_whitespace(chr)) {
-      push_token();
-    } else if (std::find(delimiters.begin(), delimiters.end(), chr) != delimiters.end()) {
-      push_token();
-      state.raw_token = chr;
-      push_token();
-    } else {
-      state.raw_token += chr;
+  // Consumes the character at `idx` (or the run of characters that can not change the mode) and returns the index of
+  // the next character to consume
+  constexpr std::size_t proceed(std::size_t idx) {
+    switch (state.mode) {
+      case LexerMode::START:
+        return start(idx, char_info(str[idx]));
+      case LexerMode::WORD:
+        idx = skip_while(idx, [](CharClass char_class) { return !ends_word(char_class); });
+        if (idx < str.size())
+          finish(idx);
+        return idx;
+      case LexerMode::STRING:
+        idx = skip_while(idx, [](CharClass char_class) {
+          return char_class != CharClass::QUOTE && char_class != CharClass::BACKSLASH;
+        });
+        if (idx == str.size())
+          return idx;
+        if (str[idx] == '\\')
+          state.mode = LexerMode::STRING_ESCAPE;
+        else
+          finish(idx);
+        return idx + 1;
+      case LexerMode::STRING_ESCAPE:
+        state.mode = LexerMode::STRING;
+        return idx + 1;
+      default:
+        break;
+    }
+
+    const CharInfo &info = char_info(str[idx]);
+    if (ends_word(info.char_class)) {
+      finish(idx);
+      return idx;
+    }
+
+    if (state.mode == LexerMode::ZERO) {
+      if (auto prefix_base = int_prefix_base(str[idx])) {
+        state.base = *prefix_base;
+        state.mode = LexerMode::INT_PREFIX;
+        return idx + 1;
+      }
+      state.base = IntBase::OCTAL;
+    }
+    state.mode = is_digit_of_base(info) ? LexerMode::INT_DIGITS : LexerMode::WORD;
+    return idx + 1;
+  }
+
+  constexpr std::size_t skip_while(std::size_t idx, auto predicate) const {
+    while (idx < str.size() && predicate(char_info(str[idx]).char_class))
+      ++idx;
+    return idx;
+  }
+
+  constexpr std::size_t start(std::size_t idx, const CharInfo &info) {
+    switch (info.char_class) {
+      case CharClass::WHITESPACE:
+        return idx + 1;
+      case CharClass::QUOTE:
+        state.mode = LexerMode::STRING;
+        state.token_start = idx + 1;
+        return idx + 1;
+      case CharClass::PUNCTUATION:
+        if (info.compound_follower && idx + 1 < str.size() && str[idx + 1] == info.compound_follower) {
+          push_token(info.compound, idx, idx + 2);
+          return idx + 2;
+        }
+        push_token(info.punctuation, idx, idx + 1);
+        return idx + 1;
+      case CharClass::DIGIT:
+        state.mode = str[idx] == '0' ? LexerMode::ZERO : LexerMode::INT_DIGITS;
+        state.base = IntBase::DECIMAL;
+        break;
+      default:
+        state.mode = LexerMode::WORD;
+        break;
     }
+    state.token_start = idx;
+    return idx + 1;
+  }
+
+  // Pushes the token being read (if any) that ends right before `end`
+  constexpr void finish(std::size_t end) {
+    switch (state.mode) {
+      case LexerMode::START:
+        return;
+      case LexerMode::WORD:
+        push_token(classify_word(str.substr(state.token_start, end - state.token_start)), end);
+        break;
+      case LexerMode::ZERO:
+      case LexerMode::INT_DIGITS:
+        push_token(TokenKind::INT_LITERAL, end);
+        break;
+      case LexerMode::INT_PREFIX:
+        // A bare prefix without digits (e.g. "0x") is not a number
+        push_token(TokenKind::IDENTIFIER, end);
+        break;
+      case LexerMode::STRING:
+      case LexerMode::STRING_ESCAPE:
+        // Ends at the closing quote, an unterminated one spans till the end of the source code
+        push_token(TokenKind::STRING_LITERAL, end);
+        break;
+    }
+    state.mode = LexerMode::START;
+  }
+
+  constexpr void push_token(TokenKind kind, std::size_t end) {
+    push_token(kind, state.token_start, end);
   }
 
-  constexpr void push_token() {
-    if (state.raw_token.empty())
-      return;
+  constexpr void push_token(TokenKind kind, std::size_t begin, std::size_t end) {
+    state.tokens.push_back({kind, static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end - begin)});
+  }
 
-    state.tokens.push_back(parse_raw_token());
-    state.raw_token.clear();
+  [[nodiscard]] constexpr bool is_digit_of_base(const CharInfo &info) const {
+    return info.char_class == CharClass::UNDERSCORE || info.digit < static_cast<std::uint8_t>(state.base);
   }
 
-  constexpr Token parse_raw_token() {
-    if (state.quoted)
-      return StringLiteral{state.raw_token};
-    else if (state.raw_token.starts_with(BINARY_PREFIX) && state.raw_token.size() > BINARY_PREFIX.size())
-      return IntLiteral{string_to_int(state.raw_token.substr(BINARY_PREFIX.size()), IntBase::BINARY)};
-    else if (state.raw_token.starts_with(DECIMAL_PREFIX) && state.raw_token.size() > DECIMAL_PREFIX.size())
-      return IntLiteral{string_to_int(state.raw_token.substr(DECIMAL_PREFIX.size()), IntBase::DECIMAL)};
-    else if (state.raw_token.starts_with(HEX_PREFIX) && state.raw_token.size() > HEX_PREFIX.size())
-      return IntLiteral{string_to_int(state.raw_token.substr(HEX_PREFIX.size()), IntBase::HEX)};
-    else if (state.raw_token.starts_with(OCTAL_PREFIX) && state.raw_token.size() > OCTAL_PREFIX.size())
-      return IntLiteral{string_to_int(state.raw_token.substr(OCTAL_PREFIX.size()), IntBase::OCTAL)};
-    else if (convertible_to_int_decimal(state.raw_token))
-      return IntLiteral{string_to_int(state.raw_token, IntBase::DECIMAL)};
-    else
-      return state.raw_token;
+  static constexpr bool ends_word(CharClass char_class) {
+    return char_class == CharClass::WHITESPACE || char_class == CharClass::QUOTE ||
+           char_class == CharClass::PUNCTUATION;
   }
 
-  static constexpr std::string_view BINARY_PREFIX{"0b"};
-  static constexpr std::string_view DECIMAL_PREFIX{"0d"};
-  static constexpr std::string_view OCTAL_PREFIX{"0"};
-  static constexpr std::string_view HEX_PREFIX{"0x"};
+  static constexpr std::optional<IntBase> int_prefix_base(char chr) {
+    for (const auto &[prefix, base]: int_literal_prefixes)
+      if (prefix.size() == 2 && prefix[1] == chr)
+        return base;
+    return std::nullopt;
+  }
+
+  static constexpr TokenKind classify_word(std::string_view word) {
+    for (const auto &[keyword, kind]: keywords)
+      if (word == keyword)
+        return kind;
+    return TokenKind::IDENTIFIER;
+  }
 
-  static constexpr auto delimiters = std::to_array(
-    {';', ':', ',', '.', '-', '+', '*', '/', '(', ')', '[', ']', '{', '}', '<', '>', '@', '&', '|', '=', '!'});
+  static constexpr auto keywords = std::to_array<std::pair<std::string_view, TokenKind>>({
+    {"let",   TokenKind::LET},
+    {"apply", TokenKind::APPLY},
+    {"while", TokenKind::WHILE},
+    {"for",   TokenKind::FOR},
+    {"in",    TokenKind::IN},
+    {"if",    TokenKind::IF},
+    {"else",  TokenKind::ELSE}});
 
   std::string_view str{};
   LexerState state{};
@@ -0,0 +1,104 @@
+#ifndef AMSL_NODE_ARENA_HPP
+#define AMSL_NODE_ARENA_HPP
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <variant>
+#include <vector>
+
+using NodeIndex = std::uint32_t;
+
+inline constexpr NodeIndex no_node = std::numeric_limits<NodeIndex>::max();
+
+// Contiguous run of child indices inside `NodeArena::children`
+struct NodeRange {
+  std::uint32_t offset{};
+  std::uint32_t size{};
+};
+
+// Sizes of both vectors of a NodeArena, everything added after it can be dropped with `NodeArena::rollback`
+struct NodeArenaCheckpoint {
+  std::size_t nodes{};
+  std::size_t children{};
+};
+
+// Tree stored as a flat vector of variant nodes, nodes refer to their children by index (single child) or by a range
+// of `children` (list of children). With `reserve` a whole tree is built with a constant number of allocations
+template<typename... Nodes>
+struct NodeArena {
+  using Node = std::variant<Nodes...>;
+
+  std::vector<Node> nodes{};
+  std::vector<NodeIndex> children{};
+  NodeIndex root{no_node};
+
+  // Every node is a child at most once, so `node_count` bounds both vectors
+  constexpr void reserve(std::size_t node_count) {
+    nodes.reserve(node_count);
+    children.reserve(node_count);
+  }
+
+  template<typename T>
+  constexpr NodeIndex add(T &&node) {
+    nodes.emplace_back(std::forward<T>(node));
+    return static_cast<NodeIndex>(nodes.size() - 1);
+  }
+
+  constexpr NodeRange add_children(std::span<const NodeIndex> indices) {
+    NodeRange range{static_cast<std::uint32_t>(children.size()), static_cast<std::uint32_t>(indices.size())};
+    children.insert(children.end(), indices.begin(), indices.end());
+    return range;
+  }
+
+  [[nodiscard]] constexpr NodeArenaCheckpoint checkpoint() const {
+    return {nodes.size(), children.size()};
+  }
+
+  // Subtrees are built bottom-up, so rolling back to a checkpoint taken before a subtree was started drops all of it
+  constexpr void rollback(NodeArenaCheckpoint checkpoint) {
+    nodes.resize(checkpoint.nodes);
+    children.resize(checkpoint.children);
+  }
+
+  [[nodiscard]] constexpr const Node &operator[](NodeIndex index) const {
+    return nodes[index];
+  }
+
+  [[nodiscard]] constexpr std::span<const NodeIndex> operator[](NodeRange range) const {
+    return std::span{children}.subspan(range.offset, range.size);
+  }
+
+  constexpr decltype(auto) visit(NodeIndex index, auto &&visitor) const {
+    return std::visit(visitor, nodes[index]);
+  }
+};
+
+// Stack of child indices of the nodes that are being built, children of a node are collected on top of it and moved
+// into the arena as one contiguous range once the node is complete
+class PendingChildren {
+public:
+  [[nodiscard]] constexpr std::size_t mark() const {
+    return indices.size();
+  }
+
+  constexpr void push(NodeIndex index) {
+    indices.push_back(index);
+  }
+
+  template<typename... Nodes>
+  constexpr NodeRange pop(NodeArena<Nodes...> &arena, std::size_t mark) {
+    auto range = arena.add_children(std::span{indices}.subspan(mark));
+    indices.resize(mark);
+    return range;
+  }
+
+  constexpr void reserve(std::size_t size) {
+    indices.reserve(size);
+  }
+
+private:
+  std::vector<NodeIndex> indices{};
+};
+
+#endif // AMSL_NODE_ARENA_HPP
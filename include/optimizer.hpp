@@ -0,0 +1,1108 @@
+#ifndef AMSL_OPTIMIZER_HPP
+#define AMSL_OPTIMIZER_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "analyzed_expression.hpp"
+#include "builtin_functions.hpp"
+
+// Value of a numeric literal or of a folded comparison, typed as the executor would type it
+using Constant = std::variant<int, double, bool>;
+
+// Every integer up to this magnitude is exactly representable as a double, folded doubles are kept below it so that
+// they are printed (and computed) exactly as at runtime
+inline constexpr double max_exact_double = 9007199254740992.0;
+
+constexpr std::optional<Constant> to_constant(std::int64_t value) {
+  if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max())
+    return std::nullopt;
+  return static_cast<int>(value);
+}
+
+constexpr std::optional<Constant> to_constant(double value) {
+  if (!(-max_exact_double < value && value < max_exact_double))
+    return std::nullopt;
+  return value;
+}
+
+// Applies `operation` with the usual arithmetic conversions (bools are promoted to ints), ints are computed in 64 bits
+// so overflow is not folded
+constexpr std::optional<Constant> fold_arithmetic(Constant lhs, Constant rhs, auto operation) {
+  return std::visit([&operation](auto lhs_value, auto rhs_value) {
+    if constexpr (std::integral<decltype(lhs_value)> && std::integral<decltype(rhs_value)>)
+      return to_constant(operation(std::int64_t{lhs_value}, std::int64_t{rhs_value}));
+    else
+      return to_constant(operation(static_cast<double>(lhs_value), static_cast<double>(rhs_value)));
+  }, lhs, rhs);
+}
+
+// std::pow of two ints, folded only for non-negative integral powers whose result is exact
+constexpr std::optional<Constant> fold_pow(Constant base, Constant power) {
+  auto *int_base = std::get_if<int>(&base);
+  auto *int_power = std::get_if<int>(&power);
+  if (!int_base || !int_power || *int_power < 0)
+    return std::nullopt;
+  double result = 1;
+  double factor = *int_base;
+  for (auto remaining = *int_power;; remaining >>= 1) {
+    if (remaining & 1) {
+      result *= factor;
+      if (!to_constant(result))
+        return std::nullopt;
+    }
+    if (remaining <= 1)
+      return result;
+    factor *= factor;
+    if (!to_constant(factor))
+      return std::nullopt;
+  }
+}
+
+constexpr Constant fold_comparison(Constant lhs, Constant rhs, auto comparison) {
+  return std::visit([&comparison](auto lhs_value, auto rhs_value) {
+    if constexpr (std::integral<decltype(lhs_value)> && std::integral<decltype(rhs_value)>)
+      return Constant{std::in_place_type<bool>, comparison(std::int64_t{lhs_value}, std::int64_t{rhs_value})};
+    else
+      return Constant{std::in_place_type<bool>,
+                      comparison(static_cast<double>(lhs_value), static_cast<double>(rhs_value))};
+  }, lhs, rhs);
+}
+
+constexpr bool is_zero(Constant value) {
+  return std::visit([](auto number) { return number == 0; }, value);
+}
+
+// Evaluates a call of a pure builtin function over constant arguments, std::nullopt if it can not be folded
+constexpr std::optional<Constant> fold_builtin(std::string_view name, std::span<const Constant> arguments) {
+  if (builtin_effect(name) != Effect::PURE)
+    return std::nullopt;
+  if (arguments.size() == 1 && name == "squared")
+    return fold_arithmetic(arguments[0], arguments[0], [](auto lhs, auto rhs) { return lhs * rhs; });
+  if (arguments.size() != 2)
+    return std::nullopt;
+  if (name == "add")
+    return fold_arithmetic(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs + rhs; });
+  if (name == "sub")
+    return fold_arithmetic(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs - rhs; });
+  if (name == "mul")
+    return fold_arithmetic(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs * rhs; });
+  if (name == "div" && !is_zero(arguments[1]))
+    return fold_arithmetic(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs / rhs; });
+  if (name == "pow")
+    return fold_pow(arguments[0], arguments[1]);
+  if (name == "lt")
+    return fold_comparison(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs < rhs; });
+  if (name == "le")
+    return fold_comparison(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs <= rhs; });
+  if (name == "gt")
+    return fold_comparison(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs > rhs; });
+  if (name == "ge")
+    return fold_comparison(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs >= rhs; });
+  if (name == "eq")
+    return fold_comparison(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs == rhs; });
+  if (name == "ne")
+    return fold_comparison(arguments[0], arguments[1], [](auto lhs, auto rhs) { return lhs != rhs; });
+  return std::nullopt;
+}
+
+// Whether evaluating `index` has no effect besides computing its value: literals, variables and calls of pure
+// builtin functions over such expressions. Host variables are excluded, host functions may change them behind the
+// script's back
+constexpr bool is_pure(const AnalyzedExpressionTree &tree, NodeIndex index) {
+  return tree.visit(index, Overload{
+    [&tree](const AnalyzedFunctionCallExpression &node) {
+      return builtin_effect(node.name) == Effect::PURE && std::ranges::all_of(
+        tree[node.parameters], [&tree](NodeIndex parameter) { return is_pure(tree, parameter); });
+    },
+    [](const AnalyzedVariableExpression &) { return true; },
+    []<typename T>(const AnalyzedLiteralExpression<T> &) { return true; },
+    [](const auto &) { return false; }
+  });
+}
+
+// Calls `callback` with the ref_id of every variable read in the subtree `index`
+constexpr void for_each_read(const AnalyzedExpressionTree &tree, NodeIndex index, auto &&callback) {
+  if (auto *variable = std::get_if<AnalyzedVariableExpression>(&tree[index]))
+    callback(variable->ref_id);
+  tree.visit(index, Overload{
+    [&](const AnalyzedExpressionList &node) {
+      for (auto expression: tree[node.expressions])
+        for_each_read(tree, expression, callback);
+    },
+    [&](const AnalyzedFunctionCallExpression &node) {
+      for (auto parameter: tree[node.parameters])
+        for_each_read(tree, parameter, callback);
+    },
+    [&](const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+      for_each_read(tree, node.initializer, callback);
+    },
+    [&](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+      for_each_read(tree, node.initializer, callback);
+    },
+    [&](const AnalyzedAssignmentExpression &node) {
+      for_each_read(tree, node.lhs, callback);
+      for_each_read(tree, node.rhs, callback);
+    },
+    [&](const AnalyzedFrameExpression &node) {
+      for_each_read(tree, node.body, callback);
+    },
+    [&](const AnalyzedWhileExpression &node) {
+      for_each_read(tree, node.condition, callback);
+      for_each_read(tree, node.body, callback);
+    },
+    [&](const AnalyzedForExpression &node) {
+      for_each_read(tree, node.begin, callback);
+      for_each_read(tree, node.end, callback);
+      for_each_read(tree, node.body, callback);
+    },
+    [&](const AnalyzedIfExpression &node) {
+      for_each_read(tree, node.condition, callback);
+      for_each_read(tree, node.then_branch, callback);
+      for_each_read(tree, node.else_branch, callback);
+    },
+    [&](const AnalyzedTailCallExpression &node) {
+      for (auto argument: tree[node.arguments])
+        for_each_read(tree, argument, callback);
+    },
+    [](const auto &) {}
+  });
+}
+
+// Rebuilds a tree node by node, every pass overrides `rewrite` only for the node kinds it changes. Nodes are rebuilt
+// in the order the analyzer built them, so declarations are visited in ref_id order
+template<typename Pass>
+class TreeRewriter {
+public:
+  constexpr explicit TreeRewriter(const AnalyzedExpressionTree &expression) : source{expression} {}
+
+  constexpr AnalyzedExpressionTree run() {
+    tree = AnalyzedExpressionTree{};
+    // Most passes only remove nodes
+    tree.reserve(source.nodes.size());
+    pending_children.reserve(source.nodes.size());
+    tree.root = rewrite(source.root);
+    return std::move(tree);
+  }
+
+protected:
+  [[nodiscard]] constexpr std::size_t frame_size() const {
+    return std::get<AnalyzedFrameExpression>(source[source.root]).size;
+  }
+
+  constexpr NodeIndex rewrite(NodeIndex index) {
+    if (auto replacement = static_cast<Pass &>(*this).replace(index))
+      return *replacement;
+    return rewrite_node(index);
+  }
+
+  constexpr NodeIndex rewrite_node(NodeIndex index) {
+    return source.visit(index, [this](const auto &node) { return static_cast<Pass &>(*this).rewrite(node); });
+  }
+
+  // Node added in place of the subtree `index` without rewriting it, if any
+  constexpr std::optional<NodeIndex> replace(NodeIndex) {
+    return std::nullopt;
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedExpressionList &node) {
+    auto mark = pending_children.mark();
+    for (auto expression: source[node.expressions])
+      pending_children.push(rewrite(expression));
+    return tree.add(AnalyzedExpressionList{pending_children.pop(tree, mark)});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFunctionCallExpression &node) {
+    auto mark = pending_children.mark();
+    for (auto parameter: source[node.parameters])
+      pending_children.push(rewrite(parameter));
+    return tree.add(AnalyzedFunctionCallExpression{node.name, pending_children.pop(tree, mark)});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationExpression &node) {
+    return tree.add(node);
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+    auto initializer = rewrite(node.initializer);
+    return tree.add(AnalyzedVariableDeclarationWithInitializerExpression{node.type, node.ref_id, initializer});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+    auto initializer = rewrite(node.initializer);
+    return tree.add(AnalyzedVariableDeclarationWithInitializerAutoTypeExpression{node.ref_id, initializer});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableExpression &node) {
+    return tree.add(node);
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedAssignmentExpression &node) {
+    auto lhs = rewrite(node.lhs);
+    auto rhs = rewrite(node.rhs);
+    return tree.add(AnalyzedAssignmentExpression{lhs, rhs});
+  }
+
+  template<typename T>
+  constexpr NodeIndex rewrite(const AnalyzedLiteralExpression<T> &node) {
+    return tree.add(node);
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFrameExpression &node) {
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedFrameExpression{node.size, body});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedHostVariableExpression &node) {
+    return tree.add(node);
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedMovedVariableExpression &node) {
+    return tree.add(node);
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedWhileExpression &node) {
+    auto condition = rewrite(node.condition);
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedWhileExpression{condition, body});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedForExpression &node) {
+    auto begin = rewrite(node.begin);
+    auto end = rewrite(node.end);
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedForExpression{node.ref_id, begin, end, body});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedIfExpression &node) {
+    auto condition = rewrite(node.condition);
+    auto then_branch = rewrite(node.then_branch);
+    auto else_branch = rewrite(node.else_branch);
+    return tree.add(AnalyzedIfExpression{condition, then_branch, else_branch});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFunctionExpression &node) {
+    auto mark = pending_children.mark();
+    for (auto parameter: source[node.parameters])
+      pending_children.push(rewrite(parameter));
+    auto parameters = pending_children.pop(tree, mark);
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedFunctionExpression{node.name, node.return_type, parameters, node.size, body});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedTailCallExpression &node) {
+    auto mark = pending_children.mark();
+    for (auto argument: source[node.arguments])
+      pending_children.push(rewrite(argument));
+    return tree.add(AnalyzedTailCallExpression{pending_children.pop(tree, mark)});
+  }
+
+  const AnalyzedExpressionTree &source;
+  AnalyzedExpressionTree tree{};
+  PendingChildren pending_children{};
+};
+
+// Replaces calls of pure builtin functions over literals with the literal they evaluate to, and reads of variables
+// that are never written after their declaration and are initialized with a numeric literal of their own type with
+// that literal. The branch an if expression with a folded condition does not take is dropped, the writes in it no
+// longer keep variables from being folded by the next run
+class ConstantFolder : public TreeRewriter<ConstantFolder> {
+public:
+  constexpr explicit ConstantFolder(const AnalyzedExpressionTree &expression) : TreeRewriter{expression} {
+    find_written_variables();
+  }
+
+  // Number of calls and reads replaced with literals and branches dropped by the last `run`
+  [[nodiscard]] constexpr std::size_t eliminated() const {
+    return folded_count;
+  }
+
+private:
+  friend class TreeRewriter<ConstantFolder>;
+  using TreeRewriter::rewrite;
+
+  constexpr void find_written_variables() {
+    written.assign(frame_size(), false);
+    constants.assign(frame_size(), std::nullopt);
+    auto mark_written = [this](NodeIndex index) {
+      auto *variable = std::get_if<AnalyzedVariableExpression>(&source[index]);
+      if (variable && variable->ref_id < written.size())
+        written[variable->ref_id] = true;
+    };
+    for (const auto &node: source.nodes) {
+      if (auto *assignment = std::get_if<AnalyzedAssignmentExpression>(&node))
+        mark_written(assignment->lhs);
+      else if (auto *call = std::get_if<AnalyzedFunctionCallExpression>(&node);
+        call && may_write_arguments(call->name))
+        for (auto parameter: source[call->parameters])
+          mark_written(parameter);
+    }
+  }
+
+  [[nodiscard]] constexpr std::optional<Constant> constant(NodeIndex index) const {
+    if (auto *literal = std::get_if<AnalyzedLiteralExpression<int>>(&tree[index]))
+      return literal->value;
+    if (auto *literal = std::get_if<AnalyzedLiteralExpression<double>>(&tree[index]))
+      return literal->value;
+    if (auto *literal = std::get_if<AnalyzedLiteralExpression<bool>>(&tree[index]))
+      return Constant{std::in_place_type<bool>, literal->value};
+    return std::nullopt;
+  }
+
+  constexpr NodeIndex add_constant(Constant value) {
+    return std::visit([this](auto number) {
+      return tree.add(AnalyzedLiteralExpression<decltype(number)>{number});
+    }, value);
+  }
+
+  // Remembers the value of a never written variable initialized with a literal of the declared type ("" is auto)
+  constexpr void record_constant(std::size_t ref_id, std::string_view type, NodeIndex initializer) {
+    auto value = constant(initializer);
+    if (!value || written[ref_id])
+      return;
+    if (type.empty() || (type == "int" && std::holds_alternative<int>(*value)) ||
+        (type == "double" && std::holds_alternative<double>(*value)) ||
+        (type == "bool" && std::holds_alternative<bool>(*value)))
+      constants[ref_id] = value;
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFunctionCallExpression &node) {
+    auto checkpoint = tree.checkpoint();
+    auto mark = pending_children.mark();
+    for (auto parameter: source[node.parameters])
+      pending_children.push(rewrite(parameter));
+    auto parameters = pending_children.pop(tree, mark);
+
+    std::vector<Constant> arguments{};
+    for (auto parameter: tree[parameters])
+      if (auto value = constant(parameter))
+        arguments.push_back(*value);
+    if (arguments.size() == parameters.size) {
+      if (auto folded = fold_builtin(node.name, arguments)) {
+        tree.rollback(checkpoint);
+        ++folded_count;
+        return add_constant(*folded);
+      }
+    }
+    return tree.add(AnalyzedFunctionCallExpression{node.name, parameters});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+    auto initializer = rewrite(node.initializer);
+    record_constant(node.ref_id, node.type, initializer);
+    return tree.add(AnalyzedVariableDeclarationWithInitializerExpression{node.type, node.ref_id, initializer});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+    auto initializer = rewrite(node.initializer);
+    record_constant(node.ref_id, {}, initializer);
+    return tree.add(AnalyzedVariableDeclarationWithInitializerAutoTypeExpression{node.ref_id, initializer});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableExpression &node) {
+    if (node.ref_id < constants.size() && constants[node.ref_id]) {
+      ++folded_count;
+      return add_constant(*constants[node.ref_id]);
+    }
+    return tree.add(node);
+  }
+
+  // The dropped branch is replaced with an empty list, so it is neither encoded nor instantiated
+  constexpr NodeIndex rewrite(const AnalyzedIfExpression &node) {
+    auto condition = rewrite(node.condition);
+    auto value = constant(condition);
+    auto then_branch = !value || !is_zero(*value) ? rewrite(node.then_branch) : drop(node.then_branch);
+    auto else_branch = !value || is_zero(*value) ? rewrite(node.else_branch) : drop(node.else_branch);
+    return tree.add(AnalyzedIfExpression{condition, then_branch, else_branch});
+  }
+
+  constexpr NodeIndex drop(NodeIndex branch) {
+    auto *list = std::get_if<AnalyzedExpressionList>(&source[branch]);
+    if (!list || list->expressions.size)
+      ++folded_count;
+    return tree.add(AnalyzedExpressionList{});
+  }
+
+  std::vector<bool> written{};
+  std::vector<std::optional<Constant>> constants{};
+  std::size_t folded_count{};
+};
+
+// Replaces repeated calls of pure builtin functions among the statements of every expression list with reads of an
+// auto variable declared right before the statement of the first of them and initialized with it, or of the auto
+// variable the first of them initializes (as long as that variable is not written). Calls are shared
+// only while none of the variables they read is written (a statement writing such a variable shares none of its calls
+// reading it), and a call is moved in front of its statement only if no I/O of that statement may happen before it
+class CommonSubexpressionEliminator : public TreeRewriter<CommonSubexpressionEliminator> {
+public:
+  constexpr explicit CommonSubexpressionEliminator(const AnalyzedExpressionTree &expression)
+    : TreeRewriter{expression} {
+    next_ref_id = frame_size();
+    groups_of.assign(source.nodes.size(), no_group);
+    replacements.assign(source.nodes.size(), no_variable);
+  }
+
+  // Number of calls replaced with a read of the first one by the last `run`
+  [[nodiscard]] constexpr std::size_t eliminated() const {
+    return eliminated_count;
+  }
+
+private:
+  friend class TreeRewriter<CommonSubexpressionEliminator>;
+  using TreeRewriter::rewrite;
+
+  static constexpr std::size_t no_group = std::string::npos;
+  static constexpr std::size_t no_variable = std::string::npos;
+
+  struct Occurrence {
+    NodeIndex call{};
+    std::size_t statement{};
+    // No I/O of the statement may happen before the call, so it can be evaluated in front of the statement
+    bool movable{};
+    // Auto variable declared by the statement and initialized with the call
+    std::size_t initialized{no_variable};
+  };
+
+  // Equal calls that share a variable, `key` is the call as text
+  struct Group {
+    std::string key{};
+    std::vector<std::size_t> reads{};
+    std::vector<Occurrence> occurrences{};
+    bool open{true};
+  };
+
+  // Variables written, I/O calls made and shareable calls of a statement, calls in pre-order
+  struct StatementEffects {
+    std::vector<std::size_t> writes{};
+    std::size_t io_calls{};
+    std::vector<std::pair<NodeIndex, std::size_t>> calls{};
+  };
+
+  [[nodiscard]] constexpr bool is_shareable(NodeIndex index) const {
+    return std::holds_alternative<AnalyzedFunctionCallExpression>(source[index]) && is_pure(source, index);
+  }
+
+  // Nested expression lists are only scanned for effects, their calls are shared by their own statements
+  constexpr void find_effects(NodeIndex index, StatementEffects &effects, std::size_t io_ancestors, bool nested) const {
+    auto mark_written = [this, &effects](NodeIndex variable_index) {
+      if (auto *variable = std::get_if<AnalyzedVariableExpression>(&source[variable_index]))
+        effects.writes.push_back(variable->ref_id);
+    };
+    if (!nested && is_shareable(index))
+      effects.calls.emplace_back(index, io_ancestors);
+    source.visit(index, Overload{
+      [&](const AnalyzedExpressionList &node) {
+        for (auto expression: source[node.expressions])
+          find_effects(expression, effects, io_ancestors, true);
+      },
+      [&](const AnalyzedFunctionCallExpression &node) {
+        auto effect = builtin_effect(node.name);
+        if (effect == Effect::IO)
+          ++effects.io_calls;
+        for (auto parameter: source[node.parameters]) {
+          if (may_write_arguments(node.name))
+            mark_written(parameter);
+          find_effects(parameter, effects, io_ancestors + (effect == Effect::IO), nested);
+        }
+      },
+      [&](const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+        find_effects(node.initializer, effects, io_ancestors, nested);
+      },
+      [&](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+        find_effects(node.initializer, effects, io_ancestors, nested);
+      },
+      [&](const AnalyzedAssignmentExpression &node) {
+        mark_written(node.lhs);
+        find_effects(node.lhs, effects, io_ancestors, nested);
+        find_effects(node.rhs, effects, io_ancestors, nested);
+      },
+      // Repeated parts of a loop are scanned like nested lists, a call evaluated on every iteration is never moved in
+      // front of the loop
+      [&](const AnalyzedWhileExpression &node) {
+        find_effects(node.condition, effects, io_ancestors, true);
+        find_effects(node.body, effects, io_ancestors, true);
+      },
+      [&](const AnalyzedForExpression &node) {
+        effects.writes.push_back(node.ref_id);
+        find_effects(node.begin, effects, io_ancestors, nested);
+        find_effects(node.end, effects, io_ancestors, nested);
+        find_effects(node.body, effects, io_ancestors, true);
+      },
+      // Only one of the branches runs, their calls are never moved in front of the condition
+      [&](const AnalyzedIfExpression &node) {
+        find_effects(node.condition, effects, io_ancestors, nested);
+        find_effects(node.then_branch, effects, io_ancestors, true);
+        find_effects(node.else_branch, effects, io_ancestors, true);
+      },
+      // Always the last statement of its list, the parameters it writes are not read by a later one
+      [&](const AnalyzedTailCallExpression &node) {
+        for (auto argument: source[node.arguments])
+          find_effects(argument, effects, io_ancestors, nested);
+      },
+      [](const auto &) {}
+    });
+  }
+
+  [[nodiscard]] static constexpr bool reads_any(const Group &group, std::span<const std::size_t> writes) {
+    return std::ranges::any_of(writes, [&group](std::size_t ref_id) {
+      return std::ranges::find(group.reads, ref_id) != group.reads.end();
+    });
+  }
+
+  [[nodiscard]] constexpr std::size_t initialized_variable(NodeIndex statement, NodeIndex call) const {
+    auto *declaration = std::get_if<AnalyzedVariableDeclarationWithInitializerAutoTypeExpression>(&source[statement]);
+    return declaration && declaration->initializer == call ? declaration->ref_id : no_variable;
+  }
+
+  [[nodiscard]] constexpr std::vector<Group> find_groups(std::span<const NodeIndex> statements) const {
+    std::vector<Group> groups{};
+    for (std::size_t idx = 0; idx < statements.size(); ++idx) {
+      StatementEffects effects{};
+      find_effects(statements[idx], effects, 0, false);
+      for (auto [call, io_ancestors]: effects.calls) {
+        Group candidate{as_string(source, call)};
+        for_each_read(source, call, [&candidate](std::size_t ref_id) { candidate.reads.push_back(ref_id); });
+        if (reads_any(candidate, effects.writes))
+          continue;
+        Occurrence occurrence{call, idx, io_ancestors == effects.io_calls, initialized_variable(statements[idx], call)};
+        auto group = std::ranges::find_if(groups, [&candidate](const Group &group) {
+          return group.open && group.key == candidate.key;
+        });
+        if (group != groups.end())
+          group->occurrences.push_back(occurrence);
+        else if (occurrence.movable) {
+          // Later calls read the initialized variable instead, so writing it ends the group too
+          if (occurrence.initialized != no_variable)
+            candidate.reads.push_back(occurrence.initialized);
+          candidate.occurrences.push_back(occurrence);
+          groups.push_back(std::move(candidate));
+        }
+      }
+      for (auto &group: groups)
+        if (reads_any(group, effects.writes))
+          group.open = false;
+    }
+    std::erase_if(groups, [](const Group &group) { return group.occurrences.size() < 2; });
+    return groups;
+  }
+
+  // Marks the outermost calls of repeated groups in pre-order, calls inside of a marked one are left to the next run
+  constexpr void mark_shared(NodeIndex index, std::vector<std::size_t> &shared_count) {
+    if (auto group = groups_of[index]; group != no_group) {
+      replacements[index] = group;
+      ++shared_count[group];
+      return;
+    }
+    source.visit(index, Overload{
+      [&](const AnalyzedFunctionCallExpression &node) {
+        for (auto parameter: source[node.parameters])
+          mark_shared(parameter, shared_count);
+      },
+      [&](const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+        mark_shared(node.initializer, shared_count);
+      },
+      [&](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+        mark_shared(node.initializer, shared_count);
+      },
+      [&](const AnalyzedAssignmentExpression &node) {
+        mark_shared(node.rhs, shared_count);
+      },
+      [&](const AnalyzedForExpression &node) {
+        mark_shared(node.begin, shared_count);
+        mark_shared(node.end, shared_count);
+      },
+      [&](const AnalyzedIfExpression &node) {
+        mark_shared(node.condition, shared_count);
+      },
+      [&](const AnalyzedTailCallExpression &node) {
+        for (auto argument: source[node.arguments])
+          mark_shared(argument, shared_count);
+      },
+      [](const auto &) {}
+    });
+  }
+
+  constexpr std::optional<NodeIndex> replace(NodeIndex index) {
+    if (replacements[index] == no_variable)
+      return std::nullopt;
+    return tree.add(AnalyzedVariableExpression{replacements[index]});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedExpressionList &node) {
+    auto statements = source[node.expressions];
+    auto groups = find_groups(statements);
+    for (std::size_t group = 0; group < groups.size(); ++group)
+      for (const auto &occurrence: groups[group].occurrences)
+        groups_of[occurrence.call] = group;
+    std::vector<std::size_t> shared_count(groups.size(), 0);
+    for (auto statement: statements)
+      if (!std::holds_alternative<AnalyzedExpressionList>(source[statement]))
+        mark_shared(statement, shared_count);
+
+    // First shared call of every group with the variable it is stored in
+    std::vector<std::pair<Occurrence, std::size_t>> declarations{};
+    for (std::size_t group = 0; group < groups.size(); ++group) {
+      auto shared = std::ranges::find_if(groups[group].occurrences, [this](const Occurrence &occurrence) {
+        return replacements[occurrence.call] != no_variable;
+      });
+      auto shares = shared_count[group] >= 2 && shared->movable;
+      auto ref_id = !shares ? no_variable : shared->initialized != no_variable ? shared->initialized : next_ref_id++;
+      for (const auto &occurrence: groups[group].occurrences) {
+        groups_of[occurrence.call] = no_group;
+        if (replacements[occurrence.call] != no_variable)
+          replacements[occurrence.call] = ref_id;
+      }
+      if (!shares)
+        continue;
+      eliminated_count += shared_count[group] - 1;
+      if (shared->initialized != no_variable)
+        replacements[shared->call] = no_variable;
+      else
+        declarations.emplace_back(*shared, ref_id);
+    }
+    std::ranges::sort(declarations, {}, [](const auto &declaration) { return declaration.first.statement; });
+
+    auto mark = pending_children.mark();
+    auto declaration = declarations.begin();
+    for (std::size_t idx = 0; idx < statements.size(); ++idx) {
+      for (; declaration != declarations.end() && declaration->first.statement == idx; ++declaration)
+        pending_children.push(tree.add(AnalyzedVariableDeclarationWithInitializerAutoTypeExpression{
+          declaration->second, rewrite_node(declaration->first.call)}));
+      pending_children.push(rewrite(statements[idx]));
+    }
+    return tree.add(AnalyzedExpressionList{pending_children.pop(tree, mark)});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFrameExpression &node) {
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedFrameExpression{next_ref_id, body});
+  }
+
+  std::size_t next_ref_id{};
+  std::vector<std::size_t> groups_of{};
+  // Variable read in place of a shared call (group index while the groups of a list are being chosen)
+  std::vector<std::size_t> replacements{};
+  std::size_t eliminated_count{};
+};
+
+enum class EliminationKind {
+  UNUSED_VARIABLE,
+  DEAD_STORE
+};
+
+// Declaration of an unused variable or store that is overwritten before it is read, `ref_id` as assigned by the
+// analyzer. Side effects of the eliminated initializer or stored value are kept
+struct Elimination {
+  EliminationKind kind{};
+  std::size_t ref_id{};
+};
+
+constexpr std::string as_string(std::span<const Elimination> eliminations) {
+  std::string str{};
+  for (std::size_t idx = 0; idx < eliminations.size(); ++idx) {
+    if (idx)
+      str += ", ";
+    str += eliminations[idx].kind == EliminationKind::UNUSED_VARIABLE ? "UnusedVariable" : "DeadStore";
+    str += "(ref_id=" + int_to_string(eliminations[idx].ref_id) + ")";
+  }
+  return str;
+}
+
+// Liveness over the statements of every expression list (every expression but the last one, whose value is the
+// value of the list):
+// * declarations of variables that are never read, and statements assigning to them, are eliminated
+// * an assignment statement is eliminated if a later statement of the same list assigns to the same variable before
+//   anything reads it
+// Side-effect free eliminated values are dropped, others are kept as statements. A variable passed to a function is
+// considered read, as is any variable used anywhere but as the target of an assignment statement
+class DeadCodeEliminator : public TreeRewriter<DeadCodeEliminator> {
+public:
+  constexpr DeadCodeEliminator(const AnalyzedExpressionTree &expression, std::vector<Elimination> &eliminations)
+    : TreeRewriter{expression}, eliminations{eliminations} {
+    find_reads();
+  }
+
+  // Number of statements eliminated by the last `run`
+  [[nodiscard]] constexpr std::size_t eliminated() const {
+    return eliminated_count;
+  }
+
+private:
+  friend class TreeRewriter<DeadCodeEliminator>;
+  using TreeRewriter::rewrite;
+
+  static constexpr std::size_t no_variable = std::string::npos;
+
+  // Variable assigned to by the statement `index`, if it is an assignment to a variable
+  [[nodiscard]] constexpr std::size_t stored_variable(NodeIndex index) const {
+    auto *assignment = std::get_if<AnalyzedAssignmentExpression>(&source[index]);
+    if (!assignment)
+      return no_variable;
+    auto *variable = std::get_if<AnalyzedVariableExpression>(&source[assignment->lhs]);
+    return variable ? variable->ref_id : no_variable;
+  }
+
+  [[nodiscard]] constexpr std::size_t declared_variable(NodeIndex index) const {
+    return source.visit(index, Overload{
+      [](const AnalyzedVariableDeclarationExpression &node) { return node.ref_id; },
+      [](const AnalyzedVariableDeclarationWithInitializerExpression &node) { return node.ref_id; },
+      [](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) { return node.ref_id; },
+      [](const auto &) { return no_variable; }
+    });
+  }
+
+  // Value computed by the statement `index` that is kept when the statement is eliminated, no_node if there is none
+  [[nodiscard]] constexpr NodeIndex stored_value(NodeIndex index) const {
+    return source.visit(index, Overload{
+      [](const AnalyzedVariableDeclarationWithInitializerExpression &node) { return node.initializer; },
+      [](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) { return node.initializer; },
+      [](const AnalyzedAssignmentExpression &node) { return node.rhs; },
+      [](const auto &) { return no_node; }
+    });
+  }
+
+  // Counts reads of every variable, the target of an assignment statement is not a read. A variable is removable if
+  // it is never read and every declaration of it and assignment to it is a statement
+  constexpr void find_reads() {
+    reads.assign(frame_size(), 0);
+    std::vector<bool> statement_target(source.nodes.size(), false);
+    std::vector<bool> declared_as_statement(frame_size(), false);
+    for (const auto &node: source.nodes) {
+      auto *list = std::get_if<AnalyzedExpressionList>(&node);
+      if (!list || !list->expressions.size)
+        continue;
+      auto statements = source[list->expressions].first(list->expressions.size - 1);
+      for (auto statement: statements) {
+        if (stored_variable(statement) != no_variable)
+          statement_target[std::get<AnalyzedAssignmentExpression>(source[statement]).lhs] = true;
+        if (auto ref_id = declared_variable(statement); ref_id != no_variable)
+          declared_as_statement[ref_id] = true;
+      }
+    }
+    for (NodeIndex index = 0; index < source.nodes.size(); ++index)
+      if (auto *variable = std::get_if<AnalyzedVariableExpression>(&source[index]);
+        variable && variable->ref_id < reads.size() && !statement_target[index])
+        ++reads[variable->ref_id];
+    for (NodeIndex index = 0; index < source.nodes.size(); ++index)
+      if (auto ref_id = declared_variable(index); ref_id != no_variable && !declared_as_statement[ref_id])
+        ++reads[ref_id];
+    // Every loop reads its variable to decide whether to go on, so stores to it in the body are never dead
+    for (const auto &node: source.nodes)
+      if (auto *loop = std::get_if<AnalyzedForExpression>(&node))
+        ++reads[loop->ref_id];
+  }
+
+  [[nodiscard]] constexpr bool is_unused(std::size_t ref_id) const {
+    return ref_id < reads.size() && !reads[ref_id];
+  }
+
+  // Walks the statements backwards keeping the variables that are assigned to by a later statement before being read
+  [[nodiscard]] constexpr std::vector<Elimination> find_eliminations(std::span<const NodeIndex> statements) const {
+    std::vector<Elimination> found(statements.size(), {EliminationKind::DEAD_STORE, no_variable});
+    std::vector<bool> overwritten(frame_size(), false);
+    auto mark_read = [&overwritten](std::size_t ref_id) {
+      if (ref_id < overwritten.size())
+        overwritten[ref_id] = false;
+    };
+    for (auto idx = statements.size() - 1; idx--;) {
+      auto statement = statements[idx];
+      auto stored = stored_variable(statement);
+      auto declared = declared_variable(statement);
+      if (is_unused(declared))
+        found[idx] = {EliminationKind::UNUSED_VARIABLE, declared};
+      else if (stored != no_variable && (is_unused(stored) || overwritten[stored]))
+        found[idx] = {EliminationKind::DEAD_STORE, stored};
+      auto value = stored_value(statement);
+      if (found[idx].ref_id != no_variable && (value == no_node || is_pure(source, value)))
+        continue;
+      // The assigned value is read before it is stored
+      if (stored != no_variable) {
+        overwritten[stored] = true;
+        for_each_read(source, std::get<AnalyzedAssignmentExpression>(source[statement]).rhs, mark_read);
+      } else
+        for_each_read(source, statement, mark_read);
+    }
+    return found;
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedExpressionList &node) {
+    auto statements = source[node.expressions];
+    std::vector<Elimination> found{};
+    if (!statements.empty())
+      found = find_eliminations(statements);
+    auto mark = pending_children.mark();
+    for (std::size_t idx = 0; idx < statements.size(); ++idx) {
+      if (idx + 1 == statements.size() || found[idx].ref_id == no_variable) {
+        pending_children.push(rewrite(statements[idx]));
+        continue;
+      }
+      eliminations.push_back(found[idx]);
+      ++eliminated_count;
+      auto value = stored_value(statements[idx]);
+      if (value != no_node && !is_pure(source, value))
+        pending_children.push(rewrite(value));
+    }
+    return tree.add(AnalyzedExpressionList{pending_children.pop(tree, mark)});
+  }
+
+  std::vector<Elimination> &eliminations;
+  std::vector<std::size_t> reads{};
+  std::size_t eliminated_count{};
+};
+
+// Renumbers the variables that are still declared by their declaration order and shrinks the frame to them. Every
+// function gets a frame of its own numbered from 0, starting with its parameters
+class FrameCompactor : public TreeRewriter<FrameCompactor> {
+public:
+  constexpr explicit FrameCompactor(const AnalyzedExpressionTree &expression) : TreeRewriter{expression} {
+    ref_ids.assign(frame_size(), std::string::npos);
+  }
+
+private:
+  friend class TreeRewriter<FrameCompactor>;
+  using TreeRewriter::rewrite;
+
+  constexpr std::size_t declare(std::size_t ref_id) {
+    return ref_ids[ref_id] = next_ref_id++;
+  }
+
+  constexpr std::size_t resolve(std::size_t ref_id) const {
+    return ref_id < ref_ids.size() ? ref_ids[ref_id] : ref_id;
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationExpression &node) {
+    return tree.add(AnalyzedVariableDeclarationExpression{node.type, declare(node.ref_id)});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+    auto initializer = rewrite(node.initializer);
+    return tree.add(AnalyzedVariableDeclarationWithInitializerExpression{node.type, declare(node.ref_id), initializer});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+    auto initializer = rewrite(node.initializer);
+    return tree.add(AnalyzedVariableDeclarationWithInitializerAutoTypeExpression{declare(node.ref_id), initializer});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedVariableExpression &node) {
+    return tree.add(AnalyzedVariableExpression{resolve(node.ref_id)});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedForExpression &node) {
+    auto begin = rewrite(node.begin);
+    auto end = rewrite(node.end);
+    auto ref_id = declare(node.ref_id);
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedForExpression{ref_id, begin, end, body});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFrameExpression &node) {
+    auto body = rewrite(node.body);
+    return tree.add(AnalyzedFrameExpression{next_ref_id, body});
+  }
+
+  constexpr NodeIndex rewrite(const AnalyzedFunctionExpression &node) {
+    auto enclosing_ref_id = std::exchange(next_ref_id, 0);
+    auto mark = pending_children.mark();
+    for (auto parameter: source[node.parameters])
+      pending_children.push(rewrite(parameter));
+    auto parameters = pending_children.pop(tree, mark);
+    auto body = rewrite(node.body);
+    auto size = std::exchange(next_ref_id, enclosing_ref_id);
+    return tree.add(AnalyzedFunctionExpression{node.name, node.return_type, parameters, size, body});
+  }
+
+  std::vector<std::size_t> ref_ids{};
+  std::size_t next_ref_id{};
+};
+
+// Turns the last read of every local into a move out of the frame, so its value is handed over instead of copied and
+// dies with the expression reading it. A read of a statement of the frame's expression list is the last one if it is
+// the only read of its variable in the statement and no later statement reads the variable before assigning to it (or
+// the statement itself assigns to it). Reads that may be bound to a reference, arguments of functions that may write
+// their arguments, stay reads. Reads repeated by a loop are moved only by a statement of the loop's body assigning to
+// the variable they read, every variable is live at the end of the body. The body of a function is looked at like the
+// frame's one, nothing in it is live after the function returns. Runs after the frames are compacted, the other
+// passes never see moved reads
+class LastUseMarker : public TreeRewriter<LastUseMarker> {
+public:
+  constexpr explicit LastUseMarker(const AnalyzedExpressionTree &expression) : TreeRewriter{expression} {
+    moved.assign(source.nodes.size(), false);
+    slot_count = frame_size();
+    for (const auto &node: source.nodes)
+      if (auto *function = std::get_if<AnalyzedFunctionExpression>(&node))
+        slot_count = std::max(slot_count, function->size);
+    find_last_uses(std::get<AnalyzedFrameExpression>(source[source.root]).body, false);
+    for (const auto &node: source.nodes) {
+      if (auto *loop = std::get_if<AnalyzedWhileExpression>(&node))
+        find_last_uses(loop->body, true);
+      else if (auto *loop = std::get_if<AnalyzedForExpression>(&node))
+        find_last_uses(loop->body, true);
+      else if (auto *function = std::get_if<AnalyzedFunctionExpression>(&node))
+        find_last_uses(function->body, false);
+    }
+  }
+
+private:
+  friend class TreeRewriter<LastUseMarker>;
+  using TreeRewriter::rewrite;
+
+  static constexpr std::size_t no_variable = std::string::npos;
+
+  struct Read {
+    std::size_t ref_id;
+    NodeIndex node;
+    bool movable;
+  };
+
+  // Reads of the subtree `index` in evaluation order, assignment targets are not reads
+  constexpr void collect_reads(NodeIndex index, bool movable, std::vector<Read> &reads) const {
+    source.visit(index, Overload{
+      [&](const AnalyzedVariableExpression &node) {
+        reads.push_back({node.ref_id, index, movable});
+      },
+      [&](const AnalyzedExpressionList &node) {
+        for (auto expression: source[node.expressions])
+          collect_reads(expression, movable, reads);
+      },
+      [&](const AnalyzedFunctionCallExpression &node) {
+        for (auto parameter: source[node.parameters])
+          collect_reads(parameter, !may_write_arguments(node.name), reads);
+      },
+      [&](const AnalyzedVariableDeclarationWithInitializerExpression &node) {
+        collect_reads(node.initializer, true, reads);
+      },
+      [&](const AnalyzedVariableDeclarationWithInitializerAutoTypeExpression &node) {
+        collect_reads(node.initializer, true, reads);
+      },
+      [&](const AnalyzedAssignmentExpression &node) {
+        if (!std::holds_alternative<AnalyzedVariableExpression>(source[node.lhs]))
+          collect_reads(node.lhs, false, reads);
+        collect_reads(node.rhs, true, reads);
+      },
+      [&](const AnalyzedWhileExpression &node) {
+        collect_repeated_reads(node.condition, reads);
+        collect_repeated_reads(node.body, reads);
+      },
+      [&](const AnalyzedForExpression &node) {
+        collect_reads(node.begin, true, reads);
+        collect_reads(node.end, true, reads);
+        collect_repeated_reads(node.body, reads);
+      },
+      [&](const AnalyzedIfExpression &node) {
+        collect_reads(node.condition, true, reads);
+        collect_reads(node.then_branch, movable, reads);
+        collect_reads(node.else_branch, movable, reads);
+      },
+      // The arguments are all evaluated before they replace the parameters
+      [&](const AnalyzedTailCallExpression &node) {
+        for (auto argument: source[node.arguments])
+          collect_reads(argument, true, reads);
+      },
+      [](const auto &) {}
+    });
+  }
+
+  // Reads that happen again on the next iteration of a loop, the statements of its body are looked at separately
+  constexpr void collect_repeated_reads(NodeIndex index, std::vector<Read> &reads) const {
+    auto first = reads.size();
+    collect_reads(index, false, reads);
+    for (auto read = reads.begin() + static_cast<std::ptrdiff_t>(first); read != reads.end(); ++read)
+      read->movable = false;
+  }
+
+  [[nodiscard]] constexpr std::size_t stored_variable(NodeIndex index) const {
+    auto *assignment = std::get_if<AnalyzedAssignmentExpression>(&source[index]);
+    if (!assignment)
+      return no_variable;
+    auto *variable = std::get_if<AnalyzedVariableExpression>(&source[assignment->lhs]);
+    return variable ? variable->ref_id : no_variable;
+  }
+
+  // Walks the statements backwards keeping the variables read by a later statement before being assigned to
+  constexpr void find_last_uses(NodeIndex body, bool live_at_end) {
+    auto *list = std::get_if<AnalyzedExpressionList>(&source[body]);
+    if (!list)
+      return;
+    std::vector<bool> live(slot_count, live_at_end);
+    std::vector<std::size_t> read_count(slot_count, 0);
+    std::vector<Read> reads{};
+    auto statements = source[list->expressions];
+    for (auto idx = statements.size(); idx--;) {
+      reads.clear();
+      collect_reads(statements[idx], true, reads);
+      for (const auto &read: reads)
+        ++read_count[read.ref_id];
+      auto stored = stored_variable(statements[idx]);
+      for (const auto &read: reads)
+        if (read.movable && read_count[read.ref_id] == 1 && (!live[read.ref_id] || read.ref_id == stored))
+          moved[read.node] = true;
+      if (stored != no_variable)
+        live[stored] = false;
+      for (const auto &read: reads) {
+        read_count[read.ref_id] = 0;
+        live[read.ref_id] = true;
+      }
+    }
+  }
+
+  constexpr std::optional<NodeIndex> replace(NodeIndex index) {
+    if (!moved[index])
+      return std::nullopt;
+    return tree.add(AnalyzedMovedVariableExpression{std::get<AnalyzedVariableExpression>(source[index]).ref_id});
+  }
+
+  std::vector<bool> moved{};
+  // Size of the largest frame, ref_ids of every frame start from 0
+  std::size_t slot_count{};
+};
+
+// Runs `Pass` until it eliminates nothing more
+template<typename Pass>
+constexpr void run_to_fixpoint(AnalyzedExpressionTree &tree, auto &... arguments) {
+  for (;;) {
+    Pass pass{tree, arguments...};
+    auto rewritten = pass.run();
+    if (!pass.eliminated())
+      return;
+    tree = std::move(rewritten);
+  }
+}
+
+// Rewrites the analyzed AST between the analyzer and the encoder: constants are folded first (dropping a branch may
+// leave the variables it wrote unwritten), then repeated pure calls are shared (calls inside of a shared one are shared
+// by the next run) and dead code is eliminated (eliminating a store may leave the variables it read unused), each until
+// nothing more can be, then the frames are compacted to the variables that are left and finally last reads of them
+// are turned into moves. Calls of the script's own functions are treated like calls of host functions
+class Optimizer {
+public:
+  constexpr explicit Optimizer(const AnalyzedExpressionTree &expression) : source{expression} {}
+
+  constexpr AnalyzedExpressionTree optimize() {
+    eliminations.clear();
+    auto tree = source;
+    run_to_fixpoint<ConstantFolder>(tree);
+    run_to_fixpoint<CommonSubexpressionEliminator>(tree);
+    run_to_fixpoint<DeadCodeEliminator>(tree, eliminations);
+    tree = FrameCompactor{tree}.run();
+    return LastUseMarker{tree}.run();
+  }
+
+  [[nodiscard]] constexpr std::span<const Elimination> eliminated() const {
+    return eliminations;
+  }
+
+private:
+  const AnalyzedExpressionTree &source;
+  std::vector<Elimination> eliminations{};
+};
+
+#endif // AMSL_OPTIMIZER_HPP
@@ -0,0 +1,188 @@
+#ifndef AMSL_OUTPUT_HPP
+#define AMSL_OUTPUT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <unistd.h>
+#include "utils.hpp"
+
+inline constexpr std::size_t output_buffer_capacity = 64 * 1024;
+
+// When the output sink writes its buffer out besides explicit `@flush()` calls and a full buffer
+enum class FlushPolicy {
+  // Never, buffered output is written only when the sink is destroyed at program exit
+  EXPLICIT,
+  // As soon as `flush_threshold` bytes are buffered
+  SIZE,
+  // When a script execution ends
+  EXIT
+};
+
+struct OutputConfig {
+  FlushPolicy policy = FlushPolicy::EXIT;
+  std::size_t flush_threshold = output_buffer_capacity;
+  // Writes the buffer straight to `file_descriptor` with write(2) instead of through std::cout
+  bool direct_write = false;
+  int file_descriptor = STDOUT_FILENO;
+};
+
+// Longest representation `format_number` produces: 64 bit integers take 20 characters, doubles 13
+inline constexpr std::size_t max_number_size = 32;
+
+// Formats `value` into [first, last) the way iostreams do by default (doubles in general format with 6 digits)
+template<typename T>
+AMSL_INLINE char *format_number(char *first, char *last, T value) {
+  if constexpr (std::floating_point<T>)
+    return std::to_chars(first, last, value, std::chars_format::general, 6).ptr;
+  else
+    return std::to_chars(first, last, value).ptr;
+}
+
+// Writes `value` to `output` (the output sink or a string being formatted) as iostreams would, values that know how
+// to write themselves (formatted text) do so
+template<typename Output, typename T>
+AMSL_INLINE void write_formatted(Output &output, const T &value) {
+  using type = std::remove_cvref_t<T>;
+  if constexpr (std::same_as<type, char>)
+    output.put(value);
+  else if constexpr (std::same_as<type, bool>)
+    output.put(value ? '1' : '0');
+  else if constexpr (std::convertible_to<const T &, std::string_view>)
+    output.write(std::string_view{value});
+  else if constexpr (std::integral<type> || std::floating_point<type>)
+    output.write_number(value);
+  else if constexpr (requires { value.write_to(output); })
+    value.write_to(output);
+  else {
+    std::ostringstream stream{};
+    stream << value;
+    output.write(stream.view());
+  }
+}
+
+// Buffer that `print` and `println` assemble their output in, numbers are formatted in place with std::to_chars (as
+// iostreams would format them by default). The buffer is written out as a whole, so a flush is one write instead of
+// one per line. The buffer is also flushed before the script blocks (reading a line, sleeping), so prompts show up
+class OutputSink {
+public:
+  OutputSink() = default;
+  OutputSink(const OutputSink &) = delete;
+  OutputSink &operator=(const OutputSink &) = delete;
+
+  ~OutputSink() {
+    flush();
+  }
+
+  // Buffered output is flushed with the previous configuration first
+  void configure(const OutputConfig &new_config) {
+    flush();
+    config = new_config;
+    if (config.flush_threshold == 0 || config.flush_threshold > buffer.size())
+      config.flush_threshold = buffer.size();
+  }
+
+  [[nodiscard]] const OutputConfig &configuration() const {
+    return config;
+  }
+
+  AMSL_INLINE void put(char chr) {
+    if (size == buffer.size())
+      flush();
+    buffer[size++] = chr;
+    flush_if_full();
+  }
+
+  AMSL_INLINE void write(std::string_view text) {
+    if (text.size() > buffer.size() - size) {
+      flush();
+      if (text.size() > buffer.size()) {
+        write_out(text.data(), text.size());
+        return;
+      }
+    }
+    std::copy(text.begin(), text.end(), buffer.begin() + size);
+    size += text.size();
+    flush_if_full();
+  }
+
+  template<typename T>
+  AMSL_INLINE void write_value(const T &value) {
+    write_formatted(*this, value);
+  }
+
+  template<typename T>
+  AMSL_INLINE void write_number(T value) {
+    if (buffer.size() - size < max_number_size)
+      flush();
+    size = static_cast<std::size_t>(format_number(buffer.data() + size, buffer.data() + buffer.size(), value) -
+                                    buffer.data());
+    flush_if_full();
+  }
+
+  AMSL_INLINE void flush() {
+    if (!size)
+      return;
+    write_out(buffer.data(), size);
+    size = 0;
+    if (!config.direct_write)
+      std::cout.flush();
+  }
+
+  // Called when a script execution ends
+  AMSL_INLINE void end_execution() {
+    if (config.policy == FlushPolicy::EXIT)
+      flush();
+  }
+
+private:
+  AMSL_INLINE void flush_if_full() {
+    if (size >= (config.policy == FlushPolicy::SIZE ? config.flush_threshold : buffer.size()))
+      flush();
+  }
+
+  void write_out(const char *data, std::size_t count) const {
+    if (!config.direct_write) {
+      std::cout.write(data, static_cast<std::streamsize>(count));
+      return;
+    }
+    while (count) {
+      auto written = ::write(config.file_descriptor, data, count);
+      if (written < 0 && errno == EINTR)
+        continue;
+      if (written <= 0)
+        return;
+      data += written;
+      count -= static_cast<std::size_t>(written);
+    }
+  }
+
+  std::array<char, output_buffer_capacity> buffer{};
+  std::size_t size{};
+  OutputConfig config{};
+};
+
+// Created on first use, so it is destroyed (and flushed) before the standard streams are
+inline OutputSink &output_sink() {
+  static OutputSink sink{};
+  return sink;
+}
+
+// Lives for one script execution, outlives the result being returned. Scripts that do not write output leave the
+// sink alone
+template<bool WritesOutput>
+struct OutputScope {
+  AMSL_INLINE ~OutputScope() {
+    if constexpr (WritesOutput)
+      output_sink().end_execution();
+  }
+};
+
+#endif // AMSL_OUTPUT_HPP
@@ -0,0 +1,168 @@
+#ifndef AMSL_PARALLEL_HPP
+#define AMSL_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct ParallelConfig {
+  // Threads the elements of an array are split over, 0 for one per hardware thread
+  unsigned threads = 0;
+  // Arrays with fewer elements are processed by the calling thread alone, 0 splits arrays of any size
+  std::size_t threshold = 1 << 16;
+};
+
+// Runs the array builtins over chunks of an array, one chunk per thread. The calling thread takes the first chunk,
+// every other one gets a thread of its own that is joined before the builtin returns
+class ParallelRunner {
+public:
+  ParallelRunner() = default;
+  ParallelRunner(const ParallelRunner &) = delete;
+  ParallelRunner &operator=(const ParallelRunner &) = delete;
+
+  void configure(const ParallelConfig &new_config) {
+    config = new_config;
+  }
+
+  [[nodiscard]] const ParallelConfig &configuration() const {
+    return config;
+  }
+
+  // Number of chunks an array of `size` elements is split into
+  [[nodiscard]] std::size_t chunk_count(std::size_t size) const {
+    if (size < config.threshold)
+      return 1;
+    std::size_t threads = config.threads ? config.threads : std::max(std::thread::hardware_concurrency(), 1U);
+    return std::min(threads, std::max<std::size_t>(size, 1));
+  }
+
+  // First element of `chunk` when `size` elements are split into `chunks` chunks, `chunks` for the end of the last one
+  [[nodiscard]] static std::size_t chunk_begin(std::size_t size, std::size_t chunks, std::size_t chunk) {
+    return size / chunks * chunk + std::min(size % chunks, chunk);
+  }
+
+  // Calls `task(index)` for every index in [0, count) at once
+  template<typename Task>
+  void run(std::size_t count, const Task &task) const {
+    std::vector<std::jthread> workers{};
+    workers.reserve(count ? count - 1 : 0);
+    for (std::size_t index = 1; index < count; ++index)
+      workers.emplace_back([&task, index]() { task(index); });
+    if (count)
+      task(0);
+  }
+
+  // Calls `task(chunk, begin, end)` for the chunks of an array of `size` elements
+  template<typename Task>
+  void run_chunks(std::size_t size, std::size_t chunks, const Task &task) const {
+    run(chunks, [&task, size, chunks](std::size_t chunk) {
+      task(chunk, chunk_begin(size, chunks, chunk), chunk_begin(size, chunks, chunk + 1));
+    });
+  }
+
+private:
+  ParallelConfig config{};
+};
+
+inline ParallelRunner &parallel_runner() {
+  static ParallelRunner runner{};
+  return runner;
+}
+
+// Callables declaring `concurrent = false` (script functions writing output or host variables) are called by the
+// calling thread alone
+template<typename Function>
+inline constexpr bool calls_concurrently = []() {
+  if constexpr (requires { Function::concurrent; })
+    return static_cast<bool>(Function::concurrent);
+  else
+    return true;
+}();
+
+// Number of chunks an array of `size` elements passed with `function` is split into
+template<typename Function>
+std::size_t chunk_count(std::size_t size) {
+  return calls_concurrently<std::remove_cvref_t<Function>> ? parallel_runner().chunk_count(size) : 1;
+}
+
+template<typename Array, typename Function>
+void parallel_for_each(Array &array, Function &function) {
+  auto &runner = parallel_runner();
+  auto size = std::size(array);
+  runner.run_chunks(size, chunk_count<Function>(size), [&array, &function](std::size_t, std::size_t begin,
+                                                                          std::size_t end) {
+    for (auto idx = begin; idx < end; ++idx)
+      std::invoke(function, array[idx]);
+  });
+}
+
+// std::vector<bool> packs its elements into shared words, so an array of bools is mapped by one thread
+template<typename Array, typename Function>
+auto parallel_map(const Array &array, Function &function) {
+  using result = std::remove_cvref_t<std::invoke_result_t<Function &, decltype(array[0])>>;
+  auto &runner = parallel_runner();
+  auto size = std::size(array);
+  std::vector<result> mapped(size);
+  runner.run_chunks(size, std::is_same_v<result, bool> ? 1 : chunk_count<Function>(size),
+                    [&array, &function, &mapped](std::size_t, std::size_t begin, std::size_t end) {
+    for (auto idx = begin; idx < end; ++idx)
+      mapped[idx] = std::invoke(function, array[idx]);
+  });
+  return mapped;
+}
+
+// The accumulator has the type `function` returns. When that is the element type, every chunk is folded starting from
+// its first element and the results of the chunks are folded in order starting from `initial`, so `function` has to
+// be associative. Other accumulators (a sum of doubles computed from integers) cannot be combined by `function`, they
+// are folded by one thread
+template<typename Array, typename Initial, typename Function>
+auto parallel_reduce(const Array &array, Initial &&initial, Function &function) {
+  using T = std::remove_cvref_t<std::invoke_result_t<Function &, Initial, decltype(array[0])>>;
+  auto &runner = parallel_runner();
+  auto size = std::size(array);
+  auto chunks = std::is_same_v<T, std::remove_cvref_t<decltype(array[0])>> ? chunk_count<Function>(size) : 1;
+  auto value = static_cast<T>(std::forward<Initial>(initial));
+  if (chunks == 1) {
+    for (const auto &element: array)
+      value = static_cast<T>(std::invoke(function, std::move(value), element));
+    return value;
+  }
+  std::vector<std::optional<T>> partial(chunks);
+  runner.run_chunks(size, chunks, [&array, &function, &partial](std::size_t chunk, std::size_t begin,
+                                                                std::size_t end) {
+    auto value = static_cast<T>(array[begin]);
+    for (auto idx = begin + 1; idx < end; ++idx)
+      value = static_cast<T>(std::invoke(function, std::move(value), array[idx]));
+    partial[chunk] = std::move(value);
+  });
+  for (auto &chunk_value: partial)
+    value = static_cast<T>(std::invoke(function, std::move(value), std::move(*chunk_value)));
+  return value;
+}
+
+// Sorts the chunks at once, then merges neighbouring runs pairwise, all the pairs of a round at once
+template<typename Array, typename Less>
+void parallel_sort(Array &array, Less &less) {
+  auto &runner = parallel_runner();
+  auto size = std::size(array);
+  auto chunks = chunk_count<Less>(size);
+  auto first = std::begin(array);
+  auto at = [first, size, chunks](std::size_t chunk) {
+    return first + static_cast<std::ptrdiff_t>(ParallelRunner::chunk_begin(size, chunks, std::min(chunk, chunks)));
+  };
+  runner.run(chunks, [&less, &at](std::size_t chunk) {
+    std::sort(at(chunk), at(chunk + 1), std::ref(less));
+  });
+  for (std::size_t width = 1; width < chunks; width *= 2)
+    runner.run((chunks + 2 * width - 1) / (2 * width), [&less, &at, width](std::size_t pair) {
+      auto begin = pair * 2 * width;
+      std::inplace_merge(at(begin), at(begin + width), at(begin + 2 * width), std::ref(less));
+    });
+}
+
+#endif // AMSL_PARALLEL_HPP
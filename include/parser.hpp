@@ -2,23 +2,32 @@
 #define AMSL_PARSER_HPP
 
 #include <vector>
+#include <optional>
 #include "token.hpp"
 #include "expression.hpp"
 #include "utils.hpp"
 
 struct ParserState {
   std::size_t current_token{};
+  ExpressionTree tree{};
+  PendingChildren pending_children{};
 };
 
 class Parser {
 public:
-  constexpr explicit Parser(const std::vector<Token> &tokens) : tokens{tokens} {}
+  constexpr explicit Parser(std::string_view source, const std::vector<Token> &tokens) : source{source},
+                                                                                         tokens{tokens} {}
 
-  constexpr ptr_wrapper<Expression> parse() {
+  constexpr ExpressionTree parse() {
     state = ParserState{};
-    return parse_expression();
+    // Every node takes at least one token
+    state.tree.reserve(tokens.size());
+    state.pending_children.reserve(tokens.size());
+    state.tree.root = parse_expression();
+    return std::move(state.tree);
   }
 
+private:
   constexpr const Token &get_next_token() {
     return tokens[state.current_token];
   }
@@ -27,102 +36,200 @@ public:
     return tokens[state.current_token++];
   }
 
-  constexpr ptr_wrapper<FunctionCallExpression> parse_function_call_expression() {
-    const auto &name = std::get<std::string>(fetch_token());
+  constexpr bool next_token_is(TokenKind kind) {
+    return state.current_token < tokens.size() && get_next_token().kind == kind;
+  }
+
+  constexpr std::string_view fetch_token_text() {
+    return fetch_token().text(source);
+  }
+
+  constexpr NodeIndex parse_function_call_expression() {
+    auto name = fetch_token_text();
     fetch_token();
 
-    auto expression = make_ptr_wrapper<FunctionCallExpression>(name);
+    auto mark = state.pending_children.mark();
     while (true) {
-      if (!expression->parameters.empty()) {
-        const auto &next_token = get_next_token();
-        if (std::holds_alternative<std::string>(next_token) && std::get<std::string>(next_token) == ",")
-          fetch_token();
-      }
-      const auto &next_token = get_next_token();
-      if (std::holds_alternative<std::string>(next_token) && std::get<std::string>(next_token) == ")") {
+      if (state.pending_children.mark() != mark && next_token_is(TokenKind::COMMA))
+        fetch_token();
+      if (next_token_is(TokenKind::RIGHT_PAREN)) {
         fetch_token();
         break;
       }
-      expression->parameters.push_back(parse_expression());
+      state.pending_children.push(parse_expression());
     }
-    return expression;
+    auto parameters = state.pending_children.pop(state.tree, mark);
+    return state.tree.add(FunctionCallExpression{name, parameters});
   }
 
-  constexpr ptr_wrapper<Expression> parse_variable_declaration_expression() {
-    auto name = std::get<std::string>(fetch_token());
-
-    std::optional<std::string> type{};
+  constexpr NodeIndex parse_variable_declaration_expression() {
+    auto name = fetch_token_text();
 
-    const auto &next_token = get_next_token();
-    if (std::holds_alternative<std::string>(next_token) && std::get<std::string>(next_token) == ":") {
+    std::optional<std::string_view> type{};
+    if (next_token_is(TokenKind::COLON)) {
       fetch_token();
-      type = std::get<std::string>(fetch_token());
+      type = fetch_type();
     }
 
-    std::optional<ptr_wrapper<Expression>> initializer{};
-    const auto &next_token2 = get_next_token();
-    if (std::holds_alternative<std::string>(next_token2) && std::get<std::string>(next_token2) == "=") {
+    std::optional<NodeIndex> initializer{};
+    if (next_token_is(TokenKind::EQUAL)) {
       fetch_token();
       initializer = parse_expression();
     }
 
     if (type.has_value()) {
       if (initializer.has_value())
-        return make_ptr_wrapper<VariableDeclarationWithInitializerExpression>(name, type.value(),
-                                                                              std::move(initializer.value()));
+        return state.tree.add(VariableDeclarationWithInitializerExpression{name, type.value(), initializer.value()});
       else
-        return make_ptr_wrapper<VariableDeclarationExpression>(name, type.value());
+        return state.tree.add(VariableDeclarationExpression{name, type.value()});
     } else
-      return make_ptr_wrapper<VariableDeclarationWithInitializerAutoTypeExpression>(name,
-                                                                                    std::move(initializer.value()));
+      return state.tree.add(VariableDeclarationWithInitializerAutoTypeExpression{name, initializer.value()});
+  }
+
+  // Text of a type: a name, a name with type arguments (`vec<float, 8>`) or a function type
+  constexpr std::string_view fetch_type() {
+    if (next_token_is(TokenKind::LEFT_BRACKET))
+      return fetch_function_type();
+    const auto &name = fetch_token();
+    if (!next_token_is(TokenKind::LESS))
+      return name.text(source);
+    std::size_t depth = 0;
+    const Token *end{};
+    do {
+      end = &fetch_token();
+      if (end->kind == TokenKind::LESS)
+        ++depth;
+      else if (end->kind == TokenKind::GREATER)
+        --depth;
+    } while (depth);
+    return source.substr(name.offset, end->offset + end->length - name.offset);
   }
 
-  constexpr ptr_wrapper<AssignmentExpression> parse_assignment_expression() {
+  // Text of a function type (`[(<parameter types>) -> <return type>]`), from the opening to the closing bracket
+  constexpr std::string_view fetch_function_type() {
+    auto begin = fetch_token().offset;
+    while (!next_token_is(TokenKind::RIGHT_BRACKET))
+      fetch_token();
+    const auto &end = fetch_token();
+    return source.substr(begin, end.offset + end.length - begin);
+  }
+
+  constexpr NodeIndex parse_assignment_expression() {
     auto lhs = parse_expression();
     fetch_token();
     auto rhs = parse_expression();
-    return make_ptr_wrapper<AssignmentExpression>(std::move(lhs), std::move(rhs));
+    return state.tree.add(AssignmentExpression{lhs, rhs});
   }
 
-  constexpr ptr_wrapper<ExpressionList> parse_expression_list() {
-    auto expression = make_ptr_wrapper<ExpressionList>();
+  constexpr NodeIndex parse_while_expression() {
+    auto condition = parse_expression();
+    auto body = parse_expression();
+    return state.tree.add(WhileExpression{condition, body});
+  }
+
+  constexpr NodeIndex parse_for_expression() {
+    auto name = fetch_token_text();
+    fetch_token();
+    auto begin = parse_expression();
+    fetch_token();
+    auto end = parse_expression();
+    auto body = parse_expression();
+    return state.tree.add(ForExpression{name, begin, end, body});
+  }
+
+  // `else if` chains are an if expression as the else branch
+  constexpr NodeIndex parse_if_expression() {
+    auto condition = parse_expression();
+    auto then_branch = parse_expression();
+    auto else_branch = no_node;
+    if (next_token_is(TokenKind::ELSE)) {
+      fetch_token();
+      else_branch = parse_expression();
+    }
+    return state.tree.add(IfExpression{condition, then_branch, else_branch});
+  }
+
+  constexpr NodeIndex parse_function_expression() {
+    fetch_token();
+    auto mark = state.pending_children.mark();
+    while (!next_token_is(TokenKind::RIGHT_PAREN)) {
+      if (next_token_is(TokenKind::COMMA))
+        fetch_token();
+      auto name = fetch_token_text();
+      std::string_view type{};
+      if (next_token_is(TokenKind::COLON)) {
+        fetch_token();
+        type = fetch_type();
+      }
+      state.pending_children.push(state.tree.add(VariableDeclarationExpression{name, type}));
+    }
+    fetch_token();
+    auto parameters = state.pending_children.pop(state.tree, mark);
+
+    std::string_view return_type{};
+    if (next_token_is(TokenKind::ARROW)) {
+      fetch_token();
+      return_type = fetch_type();
+    }
+    auto body = parse_expression();
+    fetch_token();
+    return state.tree.add(FunctionExpression{parameters, return_type, body});
+  }
+
+  constexpr NodeIndex parse_parenthesized_expression() {
+    auto expression = parse_expression();
+    fetch_token();
+    return expression;
+  }
+
+  constexpr NodeIndex parse_expression_list() {
+    auto mark = state.pending_children.mark();
     while (true) {
-      const auto &next_token = get_next_token();
-      if (std::holds_alternative<std::string>(next_token) && std::get<std::string>(next_token) == "}") {
+      if (next_token_is(TokenKind::RIGHT_BRACE)) {
         fetch_token();
         break;
       }
       auto expression_item = parse_expression();
-      if (expression_item)
-        expression->expressions.push_back(std::move(expression_item));
+      if (expression_item != no_node)
+        state.pending_children.push(expression_item);
     }
-    return expression;
+    auto expressions = state.pending_children.pop(state.tree, mark);
+    return state.tree.add(ExpressionList{expressions});
   }
 
-  constexpr ptr_wrapper<Expression> parse_expression() {
-    return std::visit<ptr_wrapper<Expression>>(Overload{
-      [](IntLiteral value) {
-        return make_ptr_wrapper<LiteralExpression<int>>(value.data);
-      },
-      [](const StringLiteral &value) { return make_ptr_wrapper<LiteralExpression<std::string>>(value.data); },
-      [this](const std::string &value) -> ptr_wrapper<Expression> {
-        if (value == ";")
-          return nullptr;
-        else if (value == "{")
-          return parse_expression_list();
-        else if (value == "@")
-          return parse_function_call_expression();
-        else if (value == "let")
-          return parse_variable_declaration_expression();
-        else if (value == "apply")
-          return parse_assignment_expression();
-        else
-          return make_ptr_wrapper<VariableExpression>(value);
-      },
-    }, fetch_token());
+  constexpr NodeIndex parse_expression() {
+    const auto &token = fetch_token();
+    switch (token.kind) {
+      case TokenKind::INT_LITERAL:
+        return state.tree.add(LiteralExpression<int>{parse_int_literal(token.text(source))});
+      case TokenKind::STRING_LITERAL:
+        return state.tree.add(LiteralExpression<EscapedString>{{token.text(source)}});
+      case TokenKind::SEMICOLON:
+        return no_node;
+      case TokenKind::LEFT_BRACE:
+        return parse_expression_list();
+      case TokenKind::AT:
+        return parse_function_call_expression();
+      case TokenKind::LET:
+        return parse_variable_declaration_expression();
+      case TokenKind::APPLY:
+        return parse_assignment_expression();
+      case TokenKind::WHILE:
+        return parse_while_expression();
+      case TokenKind::FOR:
+        return parse_for_expression();
+      case TokenKind::IF:
+        return parse_if_expression();
+      case TokenKind::LEFT_PAREN:
+        return parse_parenthesized_expression();
+      case TokenKind::LEFT_BRACKET:
+        return parse_function_expression();
+      default:
+        return state.tree.add(VariableExpression{token.text(source)});
+    }
   }
 
-private:
+  std::string_view source;
   const std::vector<Token> &tokens;
   ParserState state{};
 };
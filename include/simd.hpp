@@ -0,0 +1,81 @@
+#ifndef AMSL_SIMD_HPP
+#define AMSL_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// GCC vector extension type (`T __attribute__((vector_size(N)))`): a builtin type that is indexed like an array but is
+// neither an array nor a pointer
+template<typename T>
+concept SimdVector = !std::is_class_v<std::remove_cvref_t<T>> && !std::is_array_v<std::remove_cvref_t<T>> &&
+                     !std::is_pointer_v<std::remove_cvref_t<T>> && requires(std::remove_cvref_t<T> vector) {
+  vector[0];
+};
+
+template<SimdVector V>
+using lane_t = std::remove_cvref_t<decltype(std::declval<std::remove_cvref_t<V> &>()[0])>;
+
+template<SimdVector V>
+inline constexpr std::size_t lane_count = sizeof(std::remove_cvref_t<V>) / sizeof(lane_t<V>);
+
+// Vector of `Lanes` lanes of type T
+template<typename T, std::size_t Lanes>
+struct SimdType {
+  typedef T type __attribute__((vector_size(sizeof(T) * Lanes)));
+};
+
+// Signed integers as wide as the lanes of V, the lane indices `__builtin_shuffle` takes
+template<SimdVector V>
+using shuffle_mask_t = typename SimdType<std::make_signed_t<
+  std::conditional_t<sizeof(lane_t<V>) == 1, std::uint8_t, std::conditional_t<sizeof(lane_t<V>) == 2, std::uint16_t,
+    std::conditional_t<sizeof(lane_t<V>) == 4, std::uint32_t, std::uint64_t>>>>, lane_count<V>>::type;
+
+// Operand of a lane-wise operation with an operand of type Other: a scalar next to a vector is converted to the lane
+// type, so it is broadcast to every lane
+template<typename Other, typename T>
+constexpr decltype(auto) lane_operand(T &&value) {
+  if constexpr (SimdVector<Other> && !SimdVector<T>)
+    return static_cast<lane_t<Other>>(value);
+  else
+    return std::forward<T>(value);
+}
+
+// Parts of a `vec<T, N>` type name, spaces around the arguments are ignored
+struct SimdTypeName {
+  bool valid{};
+  std::size_t lane_type_offset{};
+  std::size_t lane_type_size{};
+  std::size_t lanes{};
+};
+
+constexpr SimdTypeName parse_simd_type_name(std::string_view name) {
+  constexpr std::string_view prefix{"vec<"};
+  if (!name.starts_with(prefix) || !name.ends_with('>'))
+    return {};
+  auto arguments = name.substr(prefix.size(), name.size() - prefix.size() - 1);
+  auto comma = arguments.find(',');
+  if (comma == std::string_view::npos)
+    return {};
+  auto trim = [](std::string_view text) {
+    while (!text.empty() && text.front() == ' ')
+      text.remove_prefix(1);
+    while (!text.empty() && text.back() == ' ')
+      text.remove_suffix(1);
+    return text;
+  };
+  auto lane_type = trim(arguments.substr(0, comma));
+  auto lanes = trim(arguments.substr(comma + 1));
+  SimdTypeName parsed{!lane_type.empty() && !lanes.empty(), static_cast<std::size_t>(lane_type.data() - name.data()),
+                      lane_type.size()};
+  for (auto chr: lanes) {
+    if (chr < '0' || chr > '9')
+      return {};
+    parsed.lanes = parsed.lanes * 10 + static_cast<std::size_t>(chr - '0');
+  }
+  return parsed;
+}
+
+#endif // AMSL_SIMD_HPP
@@ -39,7 +39,7 @@ struct string_t {
   }
 
   consteval bool operator==(const string_t<N> &str) const {
-    return std::equal(str.data, str.data + N, data);
+    return std::equal(str.data.begin(), str.data.end(), data.begin());
   }
 
   template<std::size_t N2>
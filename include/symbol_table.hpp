@@ -0,0 +1,105 @@
+#ifndef AMSL_SYMBOL_TABLE_HPP
+#define AMSL_SYMBOL_TABLE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using IdentifierId = std::uint32_t;
+
+inline constexpr IdentifierId no_identifier = std::numeric_limits<IdentifierId>::max();
+
+// FNV-1a
+constexpr std::uint64_t hash_identifier(std::string_view name) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (char chr: name) {
+    hash ^= static_cast<unsigned char>(chr);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Maps every distinct name to a dense id, open addressing with linear probing over a power of two sized table
+class IdentifierTable {
+public:
+  constexpr IdentifierId intern(std::string_view name) {
+    if ((names.size() + 1) * 2 > slots.size())
+      grow();
+    auto slot = find_slot(name);
+    if (slots[slot] == no_identifier) {
+      slots[slot] = static_cast<IdentifierId>(names.size());
+      names.push_back(name);
+    }
+    return slots[slot];
+  }
+
+  [[nodiscard]] constexpr IdentifierId find(std::string_view name) const {
+    return slots.empty() ? no_identifier : slots[find_slot(name)];
+  }
+
+  [[nodiscard]] constexpr std::size_t size() const {
+    return names.size();
+  }
+
+private:
+  [[nodiscard]] constexpr std::size_t find_slot(std::string_view name) const {
+    auto mask = slots.size() - 1;
+    for (auto slot = static_cast<std::size_t>(hash_identifier(name)) & mask;; slot = (slot + 1) & mask)
+      if (slots[slot] == no_identifier || names[slots[slot]] == name)
+        return slot;
+  }
+
+  constexpr void grow() {
+    slots.assign(slots.empty() ? 16 : slots.size() * 2, no_identifier);
+    for (IdentifierId id = 0; id < names.size(); ++id)
+      slots[find_slot(names[id])] = id;
+  }
+
+  std::vector<IdentifierId> slots{};
+  std::vector<std::string_view> names{};
+};
+
+// Current binding of every interned name, declarations shadow the previous binding until the scope they were made in
+// is left. Both declaration and lookup are O(1), leaving a scope is O(declarations made in it)
+class SymbolTable {
+public:
+  static constexpr std::size_t unbound = std::string::npos;
+
+  constexpr void enter_scope() {
+    scope_marks.push_back(shadowed.size());
+  }
+
+  constexpr void leave_scope() {
+    for (auto mark = scope_marks.back(); shadowed.size() > mark; shadowed.pop_back())
+      bindings[shadowed.back().identifier] = shadowed.back().ref_id;
+    scope_marks.pop_back();
+  }
+
+  constexpr void declare(std::string_view name, std::size_t ref_id) {
+    auto identifier = identifiers.intern(name);
+    if (identifier >= bindings.size())
+      bindings.resize(identifiers.size(), unbound);
+    shadowed.push_back({identifier, bindings[identifier]});
+    bindings[identifier] = ref_id;
+  }
+
+  [[nodiscard]] constexpr std::size_t lookup(std::string_view name) const {
+    auto identifier = identifiers.find(name);
+    return identifier == no_identifier ? unbound : bindings[identifier];
+  }
+
+private:
+  struct ShadowedBinding {
+    IdentifierId identifier{};
+    std::size_t ref_id{};
+  };
+
+  IdentifierTable identifiers{};
+  std::vector<std::size_t> bindings{};
+  std::vector<ShadowedBinding> shadowed{};
+  std::vector<std::size_t> scope_marks{};
+};
+
+#endif // AMSL_SYMBOL_TABLE_HPP
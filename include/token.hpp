@@ -1,17 +1,63 @@
 #ifndef AMSL_TOKEN_HPP
 #define AMSL_TOKEN_HPP
 
-#include <variant>
-#include <string>
+#include <cstdint>
+#include <string_view>
 
-template<typename T>
-struct Literal {
-  T data{};
+enum class TokenKind : std::uint8_t {
+  IDENTIFIER,
+  INT_LITERAL,
+  STRING_LITERAL,
+  LET,
+  APPLY,
+  WHILE,
+  FOR,
+  IN,
+  IF,
+  ELSE,
+  SEMICOLON,
+  COLON,
+  COMMA,
+  DOT,
+  MINUS,
+  PLUS,
+  STAR,
+  SLASH,
+  LEFT_PAREN,
+  RIGHT_PAREN,
+  LEFT_BRACKET,
+  RIGHT_BRACKET,
+  LEFT_BRACE,
+  RIGHT_BRACE,
+  LESS,
+  GREATER,
+  AT,
+  AMPERSAND,
+  PIPE,
+  EQUAL,
+  EXCLAMATION,
+  ARROW,
+  RANGE
 };
 
-using IntLiteral = Literal<int>;
-using StringLiteral = Literal<std::string>;
+constexpr std::string_view token_kind_name(TokenKind kind) {
+  constexpr std::string_view names[]{
+    "IDENTIFIER", "INT_LITERAL", "STRING_LITERAL", "LET", "APPLY", "WHILE", "FOR", "IN", "IF", "ELSE", "SEMICOLON",
+    "COLON", "COMMA", "DOT", "MINUS", "PLUS", "STAR", "SLASH", "LEFT_PAREN", "RIGHT_PAREN", "LEFT_BRACKET",
+    "RIGHT_BRACKET", "LEFT_BRACE", "RIGHT_BRACE", "LESS", "GREATER", "AT", "AMPERSAND", "PIPE", "EQUAL", "EXCLAMATION",
+    "ARROW", "RANGE"};
+  return names[static_cast<std::size_t>(kind)];
+}
 
-using Token = std::variant<IntLiteral, StringLiteral, std::string>;
+// View into the source code, string literal tokens span the raw (still escaped) text between the quotes
+struct Token {
+  TokenKind kind{};
+  std::uint32_t offset{};
+  std::uint32_t length{};
+
+  [[nodiscard]] constexpr std::string_view text(std::string_view source) const {
+    return source.substr(offset, length);
+  }
+};
 
 #endif // AMSL_TOKEN_HPP
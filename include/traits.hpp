@@ -3,6 +3,7 @@
 
 #include <type_traits>
 #include <iterator>
+#include <utility>
 
 template<typename T>
 concept Trivial = std::is_trivially_copyable_v<T>;
@@ -38,4 +39,25 @@ using ref_wrapper_t = ref_wrapper<T>::type;
 template<typename T>
 using const_ref_wrapper_t = const_ref_wrapper<T>::type;
 
+template<std::size_t Idx, typename T>
+struct indexed_type {
+  using type = T;
+};
+
+template<typename Indices, typename... Ts>
+struct indexed_types;
+
+template<std::size_t... Idx, typename... Ts>
+struct indexed_types<std::index_sequence<Idx...>, Ts...> : indexed_type<Idx, Ts> ... {
+};
+
+template<std::size_t Idx, typename T>
+indexed_type<Idx, T> select_indexed_type(const indexed_type<Idx, T> &);
+
+// Selects the Idx-th type of a pack by overload resolution instead of recursion, so the template depth does not grow
+// with the pack size
+template<std::size_t Idx, typename... Ts>
+using pack_element_t = typename decltype(select_indexed_type<Idx>(
+  std::declval<indexed_types<std::index_sequence_for<Ts...>, Ts...>>()))::type;
+
 #endif // AMSL_TRAITS_HPP
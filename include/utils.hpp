@@ -12,35 +12,6 @@
 
 #define AMSL_INLINE inline __attribute__((always_inline))
 
-template<std::size_t N, typename... Args>
-struct get_nth_argument_helper {
-  static_assert(N < sizeof...(Args), "Index out of range");
-};
-
-template<std::size_t N, typename T, typename... Ts>
-struct get_nth_argument_helper<N, T, Ts...> : get_nth_argument_helper<N - 1, Ts...> {
-  constexpr static AMSL_INLINE decltype(auto) get(T &&value, Ts &&... args) {
-    return get_nth_argument_helper<N - 1, Ts...>::get(args...);
-  }
-};
-
-template<typename T, typename... Ts>
-struct get_nth_argument_helper<0, T, Ts...> {
-  constexpr static AMSL_INLINE decltype(auto) get(T &&value, Ts &&... args) {
-    return value;
-  }
-};
-
-template<std::size_t I, typename... Ts>
-constexpr AMSL_INLINE decltype(auto) get_nth_argument(Ts &&... args) {
-  return get_nth_argument_helper<I, Ts...>::get(std::forward<Ts>(args)...);
-}
-
-template<std::size_t I, typename... Ts>
-constexpr AMSL_INLINE decltype(auto) get_last_nth_argument(Ts &&... args) {
-  return get_nth_argument<sizeof...(Ts) - I - 1, Ts...>(std::forward<Ts>(args)...);
-}
-
 template<typename... Ts>
 struct Overload : Ts ... {
   using Ts::operator()...;
@@ -97,8 +68,13 @@ constexpr int string_to_int(std::string_view str, IntBase base = IntBase::DECIMA
 template<typename T>
 constexpr std::string int_to_string(T value, IntBase base = IntBase::DECIMAL) {
   std::string str{};
-  for (; value != T{}; value /= static_cast<int>(base))
-    str += int_to_char(value % static_cast<int>(base), base);
+  auto negative = value < T{};
+  for (; value != T{}; value /= static_cast<int>(base)) {
+    auto digit = value % static_cast<int>(base);
+    str += int_to_char(negative ? -digit : digit, base);
+  }
+  if (negative)
+    str += '-';
   std::reverse(str.begin(), str.end());
   if (str.empty())
     return "0";
@@ -106,13 +82,39 @@ constexpr std::string int_to_string(T value, IntBase base = IntBase::DECIMAL) {
     return str;
 }
 
-constexpr bool convertible_to_int_decimal(std::string_view str) {
-  return !str.empty() && std::ranges::all_of(str, [](char chr) { return ('0' <= chr) && (chr <= '9'); });
-}
+// Fixed notation with up to `precision` fractional digits, `value` must fit into std::int64_t
+constexpr std::string double_to_string(double value, int precision = 6) {
+  std::string str = value < 0 ? "-" : "";
+  value = value < 0 ? -value : value;
+  auto integral = static_cast<std::int64_t>(value);
+  str += int_to_string(integral) + ".";
+  auto fraction = value - static_cast<double>(integral);
+  auto digits = 0;
+  do {
+    fraction *= 10;
+    auto digit = static_cast<int>(fraction);
+    str += static_cast<char>('0' + digit);
+    fraction -= digit;
+  } while (++digits < precision && fraction > 0);
+  return str;
+}
+
+struct IntLiteralPrefix {
+  std::string_view prefix;
+  IntBase base;
+};
 
-constexpr bool is_whitespace(char c) {
-  constexpr char whitespaces[]{' ', '\n', '\r', '\f', '\v', '\t'};
-  return std::any_of(std::begin(whitespaces), std::end(whitespaces), [c](char chr) { return c == chr; });
+constexpr IntLiteralPrefix int_literal_prefixes[]{
+  {"0b", IntBase::BINARY},
+  {"0d", IntBase::DECIMAL},
+  {"0x", IntBase::HEX},
+  {"0",  IntBase::OCTAL}};
+
+constexpr int parse_int_literal(std::string_view str) {
+  for (const auto &[prefix, base]: int_literal_prefixes)
+    if (str.starts_with(prefix) && str.size() > prefix.size())
+      return string_to_int(str.substr(prefix.size()), base);
+  return string_to_int(str, IntBase::DECIMAL);
 }
 
 constexpr std::string escape(const std::string &text) {
@@ -140,40 +142,70 @@ constexpr std::string escape(const std::string &text) {
   return str + "\"";
 }
 
-auto as_string_t(auto str_generator) {
-  constexpr std::size_t size = str_generator().size();
-  return string_t<size>{str_generator()};
+// Calls `output` with every character that the escaped `text` stands for
+constexpr void unescape(std::string_view text, auto output) {
+  bool escaped{};
+  for (char chr: text) {
+    if (escaped) {
+      if (chr == 'n')
+        output('\n');
+      else if (chr == 't')
+        output('\t');
+      else if (chr == 'r')
+        output('\r');
+      else if (chr == 'a')
+        output('\a');
+      else if (chr == 'f')
+        output('\f');
+      else if (chr == 'v')
+        output('\v');
+      else if (chr == 'b')
+        output('\b');
+      else
+        output(chr);
+      escaped = false;
+    } else if (chr == '\\')
+      escaped = true;
+    else
+      output(chr);
+  }
 }
 
-template<typename T, auto MaxSize>
-struct oversized_array {
-  std::array<T, MaxSize> data{};
+constexpr std::size_t unescaped_size(std::string_view text) {
   std::size_t size{};
+  unescape(text, [&size](char) { ++size; });
+  return size;
+}
+
+constexpr std::string unescape(std::string_view text) {
+  std::string str{};
+  str.reserve(unescaped_size(text));
+  unescape(text, [&str](char chr) { str += chr; });
+  return str;
+}
+
+// String literal as written in the source code, decoded only when it is encoded or printed
+struct EscapedString {
+  std::string_view text{};
 };
 
-template<auto MaxSize, typename T>
-consteval auto to_oversized_array(const std::vector<T> &bytes) {
-  oversized_array<T, MaxSize> result{};
-  std::copy(bytes.begin(), bytes.end(), result.data.begin());
-  result.size = bytes.size();
-  return result;
+auto as_string_t(auto str_generator) {
+  constexpr std::size_t size = str_generator().size();
+  return string_t<size>{str_generator()};
 }
 
-template<auto MaxSize>
+// Materializes a constexpr-sized array from a generator returning a vector: the first call only determines the size,
+// the second one fills an exactly sized array, so no size limit or oversized intermediate buffer is needed
 consteval auto to_right_sized_array(auto generator) {
-  constexpr auto oversized = to_oversized_array<MaxSize>(generator());
-  std::array<typename decltype(oversized.data)::value_type, oversized.size> result;
-  std::copy(oversized.data.begin(), std::next(oversized.data.begin(), oversized.size), result.begin());
+  constexpr std::size_t size = generator().size();
+  auto data = generator();
+  std::array<typename decltype(data)::value_type, size> result{};
+  std::copy(data.begin(), data.end(), result.begin());
   return result;
 }
 
-template<auto MaxSize>
 consteval auto to_byte_array(auto generator) {
-  return to_right_sized_array<MaxSize>(generator);
-}
-
-constexpr auto &take_ref(auto &obj) noexcept {
-  return obj;
+  return to_right_sized_array(generator);
 }
 
 inline std::chrono::high_resolution_clock::time_point get_current_time_fenced() {
@@ -4,6 +4,7 @@
 #include "string.hpp"
 #include "parser.hpp"
 #include "analyzer.hpp"
+#include "optimizer.hpp"
 #include "encoder.hpp"
 #include "compiler.hpp"
 
@@ -12,18 +13,21 @@ int main() {
 
   auto introspection_str = as_string_t([]() {
     auto tokens = Lexer{source}.tokenize();
-    auto expression = Parser{tokens}.parse();
+    auto expression = Parser{source, tokens}.parse();
     auto analyzed_expression = Analyzer{expression}.analyze();
-    auto bytes = encode_to_bytes(analyzed_expression);
+    Optimizer optimizer{analyzed_expression};
+    auto optimized_expression = optimizer.optimize();
+    auto bytes = encode_to_bytes(optimized_expression);
 
     auto generator = []() {
       auto tokens = Lexer{source}.tokenize();
-      auto expression = Parser{tokens}.parse();
+      auto expression = Parser{source, tokens}.parse();
       auto analyzed_expression = Analyzer{expression}.analyze();
-      return encode_to_bytes(analyzed_expression);
+      auto optimized_expression = Optimizer{analyzed_expression}.optimize();
+      return encode_to_bytes(optimized_expression);
     };
-    static constexpr auto byte_array = to_byte_array<10 * 1024 * 1024>(generator);
-    using TB_AST = Compiler<byte_array.begin()>::compiled;
+    static constexpr auto byte_array = to_byte_array(generator);
+    using TB_AST = ProgramCompiler<byte_array.begin()>::compiled;
 
     std::string str = "Step 1 - Embedder\nSource code:\n";
     str += source;
@@ -32,18 +36,19 @@ int main() {
     for (std::size_t idx = 0; idx < tokens.size(); ++idx) {
       if (idx)
         str += ", ";
-      std::visit(Overload{
-        [&str](IntLiteral value) { str += "IntLiteral(" + int_to_string(value.data) + ")"; },
-        [&str](const StringLiteral &value) { str += "StringLiteral(" + escape(value.data) + ")"; },
-        [&str](const std::string &value) { str += "string(" + escape(value) + ")"; },
-      }, tokens[idx]);
+      auto text = tokens[idx].text(source);
+      str += std::string{token_kind_name(tokens[idx].kind)} + "(";
+      str += escape(tokens[idx].kind == TokenKind::STRING_LITERAL ? unescape(text) : std::string{text}) + ")";
     }
     str += "]\n\n";
-    str += "Step 3 - Parser\nAST: " + expression->as_string();
+    str += "Step 3 - Parser\nAST: " + as_string(expression);
     str += "\n\n";
-    str += "Step 4 - Analyzer\nAnalyzed AST: " + analyzed_expression->as_string();
+    str += "Step 4 - Analyzer\nAnalyzed AST: " + as_string(analyzed_expression);
     str += "\n\n";
-    str += "Step 5 - Encoder\nByte vector: [";
+    str += "Step 5 - Optimizer\nEliminated: [" + as_string(optimizer.eliminated()) + "]\n";
+    str += "Optimized AST: " + as_string(optimized_expression);
+    str += "\n\n";
+    str += "Step 6 - Encoder\nByte vector: [";
     for (std::size_t idx = 0; idx < bytes.size(); ++idx) {
       if (idx)
         str += ", ";
@@ -52,7 +57,7 @@ int main() {
     }
     str += "]";
     str += "\n\n";
-    str += "Step 6 - Runtime to compile-time wall\nByte array: [";
+    str += "Step 7 - Runtime to compile-time wall\nByte array: [";
     for (std::size_t idx = 0; idx < byte_array.size(); ++idx) {
       if (idx)
         str += ", ";
@@ -61,10 +66,10 @@ int main() {
     }
     str += "]";
     str += "\n\n";
-    str += "Step 7 - Compiler\nTB-AST: ";
+    str += "Step 8 - Compiler\nTB-AST: ";
     str += get_type_name<TB_AST>();
     str += "\n\n";
-    str += "Step 8 - Executor\nExecuting here ...";
+    str += "Step 9 - Executor\nExecuting here ...";
     return str;
   });
   std::cout << std::string_view{introspection_str.data.begin(), introspection_str.data.end()} << std::endl;